@@ -0,0 +1,654 @@
+/*
+=================================================================
+LSP-BENCH – MICROBENCHMARK HARNESS FOR THE DEMO SYSCALLS (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How every demo operation becomes a registered microbenchmark
+2. How warmup and adaptive iteration counts are chosen
+3. How mean, standard deviation and percentiles are computed
+4. How results are written as JSON for regression tracking
+5. How kernel and machine information is attached to results
+
+DEFINITION:
+A microbenchmark runs one small operation (for example
+open() + close()) many times and measures how long a single
+operation takes. The harness first warms up caches, then picks
+a batch size so that one timed sample is long enough to be
+measured precisely, collects many samples, and reports their
+statistics.
+
+SYNTAX (MAJOR CALLS USED):
+int clock_gettime(clockid_t clockid, struct timespec *tp);
+int uname(struct utsname *buf);
+
+SYNTAX EXPLANATION:
+struct benchmark  -> { name, setup(), run(), teardown() }
+                     run() performs ONE operation
+
+batch             -> Number of operations timed together as one
+                     sample (chosen so a sample lasts ~1 ms)
+
+sample            -> Time of one batch / batch size
+                     = time per operation
+
+KEY POINTS:
+- Warmup: operations run for WARMUP_MS before measuring
+- Batch size adapts: fast ops get big batches, fork+exec gets 1
+- Sampling stops after TARGET time or MAX_SAMPLES samples
+- Reported per operation: mean, stddev, min, p50, p90, p99
+- JSON contains kernel release, CPU model and CPU count
+- A filter string runs only matching benchmarks
+
+REGISTERED BENCHMARKS:
+open_close            -> open() + close() of a private temp file
+read_64 .. read_1m    -> pread() of 64 B, 4 KB, 64 KB, 1 MB
+write_64 .. write_1m  -> pwrite() of 64 B, 4 KB, 64 KB, 1 MB
+readlink              -> readlink("/bin/sh")
+socket_create         -> socket(AF_INET, SOCK_STREAM) + close()
+socketpair_create     -> socketpair() + 2 x close()
+socketpair_roundtrip  -> send() + recv() to an echo child
+fork_wait             -> fork() + _exit() + waitpid()
+fork_exec             -> fork() + execl("/bin/true") + waitpid()
+
+WHY A HARNESS?
+- The demos run each call once, without timing
+- Repeated, statistically summarized runs are comparable
+- JSON makes it easy to track kernels and machines over time
+
+IMPORTANT APIs:
+clock_gettime() -> Timing
+uname()         -> Kernel release in the JSON report
+open(), pread(), pwrite(), readlink(), socket(),
+socketpair(), send(), recv(), fork(), execl(), waitpid()
+                -> The operations being measured
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Parses options (filter, target time, JSON file)
+STEP 2: For each registered benchmark: setup()
+STEP 3: Warmup, then calibrate the batch size
+STEP 4: Collects samples until time or sample limit
+STEP 5: Computes statistics, prints one table row
+STEP 6: teardown(), then writes the JSON report
+
+COMPILE:
+gcc -O2 lsp_bench.c -o lsp-bench -lm
+./lsp-bench [-f filter] [-t seconds] [-j results.json]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Kernel and CPU information
+2. One row per benchmark: batch, samples, mean, stddev,
+   min, p50, p90, p99 in nanoseconds
+3. JSON file with the same data (with -j)
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), fprintf(), fopen()
+#include <stdlib.h>       // For malloc(), qsort(), atof(), mkstemp()
+#include <string.h>       // For memset(), strstr(), strcpy()
+#include <math.h>         // For sqrt()
+#include <fcntl.h>        // For open()
+#include <time.h>         // For clock_gettime(), time()
+#include <unistd.h>       // For pread(), pwrite(), fork(), execl(), unlink()
+#include <sys/socket.h>   // For socket(), socketpair(), send(), recv()
+#include <sys/types.h>    // For pid_t
+#include <sys/utsname.h>  // For uname()
+#include <sys/wait.h>     // For waitpid()
+#include <netinet/in.h>   // For AF_INET
+
+#define WARMUP_MS     50.0
+#define SAMPLE_MS     1.0
+#define MAX_SAMPLES   2000
+#define MIN_SAMPLES   10
+#define BENCH_TEMPLATE "lsp_bench.XXXXXX"
+#define MAX_IO_SIZE   (1024 * 1024)
+
+/*
+One registered microbenchmark.
+arg is passed to every callback (e.g. the I/O size).
+*/
+struct benchmark
+{
+    const char *name;
+    long        arg;
+    int  (*setup)(long arg);
+    int  (*run)(long arg);
+    void (*teardown)(void);
+};
+
+/*
+Statistics of one benchmark, in nanoseconds per operation.
+*/
+struct result
+{
+    const char *name;
+    long        batch;
+    int         samples;
+    double      mean, stddev, min, p50, p90, p99;
+};
+
+/* Shared state of the benchmarks */
+static int   bench_fd = -1;
+static int   pair[2] = { -1, -1 };
+static pid_t echo_pid;
+static char *io_buf;
+static char  bench_path[] = BENCH_TEMPLATE;
+
+/*
+-----------------------------------------------------------------
+NOW IN NANOSECONDS
+-----------------------------------------------------------------
+*/
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+-----------------------------------------------------------------
+FILE BENCHMARKS
+-----------------------------------------------------------------
+*/
+static void teardown_file(void)
+{
+    close(bench_fd);
+    unlink(bench_path);
+    bench_fd = -1;
+    free(io_buf);
+    io_buf = NULL;
+}
+
+static int setup_file(long arg)
+{
+    (void)arg;
+
+    io_buf = malloc(MAX_IO_SIZE);
+    if (io_buf == NULL)
+    {
+        return -1;
+    }
+    memset(io_buf, 'x', MAX_IO_SIZE);
+
+    /* Private scratch file: never touch the demo's x.txt */
+    strcpy(bench_path, BENCH_TEMPLATE);
+    bench_fd = mkstemp(bench_path);
+    if (bench_fd == -1)
+    {
+        return -1;
+    }
+    if (pwrite(bench_fd, io_buf, MAX_IO_SIZE, 0) != MAX_IO_SIZE)
+    {
+        teardown_file();
+        return -1;
+    }
+    return 0;
+}
+
+static int run_open_close(long arg)
+{
+    (void)arg;
+
+    int fd = open(bench_path, O_RDONLY);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    return close(fd);
+}
+
+static int run_read(long size)
+{
+    return pread(bench_fd, io_buf, size, 0) == size ? 0 : -1;
+}
+
+static int run_write(long size)
+{
+    return pwrite(bench_fd, io_buf, size, 0) == size ? 0 : -1;
+}
+
+static int run_readlink(long arg)
+{
+    char link_buf[100];
+
+    (void)arg;
+    return readlink("/bin/sh", link_buf, sizeof(link_buf) - 1) == -1 ? -1 : 0;
+}
+
+/*
+-----------------------------------------------------------------
+SOCKET BENCHMARKS
+-----------------------------------------------------------------
+*/
+static int run_socket_create(long arg)
+{
+    (void)arg;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    return close(fd);
+}
+
+static int run_socketpair_create(long arg)
+{
+    int sv[2];
+
+    (void)arg;
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+    {
+        return -1;
+    }
+    close(sv[0]);
+    return close(sv[1]);
+}
+
+/*
+Echo child: sends back every message it receives.
+*/
+static int setup_roundtrip(long arg)
+{
+    (void)arg;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1)
+    {
+        return -1;
+    }
+
+    echo_pid = fork();
+    if (echo_pid == -1)
+    {
+        return -1;
+    }
+    if (echo_pid == 0)
+    {
+        char buf[64];
+        ssize_t n;
+
+        close(pair[0]);
+        while ((n = recv(pair[1], buf, sizeof(buf), 0)) > 0)
+        {
+            send(pair[1], buf, n, 0);
+        }
+        _exit(0);
+    }
+
+    close(pair[1]);
+    return 0;
+}
+
+static int run_roundtrip(long arg)
+{
+    char buf[5];
+
+    (void)arg;
+    if (send(pair[0], "Hello", 5, 0) != 5)
+    {
+        return -1;
+    }
+    return recv(pair[0], buf, sizeof(buf), MSG_WAITALL) == 5 ? 0 : -1;
+}
+
+static void teardown_roundtrip(void)
+{
+    close(pair[0]);
+    waitpid(echo_pid, NULL, 0);
+}
+
+/*
+-----------------------------------------------------------------
+PROCESS BENCHMARKS
+-----------------------------------------------------------------
+*/
+static int run_fork_wait(long arg)
+{
+    (void)arg;
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        return -1;
+    }
+    if (pid == 0)
+    {
+        _exit(0);
+    }
+    return waitpid(pid, NULL, 0) == pid ? 0 : -1;
+}
+
+static int run_fork_exec(long arg)
+{
+    int status;
+
+    (void)arg;
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        return -1;
+    }
+    if (pid == 0)
+    {
+        execl("/bin/true", "true", NULL);
+        _exit(127);
+    }
+    if (waitpid(pid, &status, 0) != pid)
+    {
+        return -1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+/*
+-----------------------------------------------------------------
+BENCHMARK REGISTRY
+-----------------------------------------------------------------
+*/
+static const struct benchmark benchmarks[] =
+{
+    { "open_close",           0,       setup_file,      run_open_close,        teardown_file },
+    { "read_64",              64,      setup_file,      run_read,              teardown_file },
+    { "read_4k",              4096,    setup_file,      run_read,              teardown_file },
+    { "read_64k",             65536,   setup_file,      run_read,              teardown_file },
+    { "read_1m",              1048576, setup_file,      run_read,              teardown_file },
+    { "write_64",             64,      setup_file,      run_write,             teardown_file },
+    { "write_4k",             4096,    setup_file,      run_write,             teardown_file },
+    { "write_64k",            65536,   setup_file,      run_write,             teardown_file },
+    { "write_1m",             1048576, setup_file,      run_write,             teardown_file },
+    { "readlink",             0,       NULL,            run_readlink,          NULL },
+    { "socket_create",        0,       NULL,            run_socket_create,     NULL },
+    { "socketpair_create",    0,       NULL,            run_socketpair_create, NULL },
+    { "socketpair_roundtrip", 0,       setup_roundtrip, run_roundtrip,         teardown_roundtrip },
+    { "fork_wait",            0,       NULL,            run_fork_wait,         NULL },
+    { "fork_exec",            0,       NULL,            run_fork_exec,         NULL },
+};
+
+#define BENCH_COUNT ((int)(sizeof(benchmarks) / sizeof(benchmarks[0])))
+
+/*
+-----------------------------------------------------------------
+RUN A BATCH, RETURN NANOSECONDS PER OPERATION
+-----------------------------------------------------------------
+*/
+static double run_batch(const struct benchmark *b, long batch)
+{
+    double start = now_ns();
+
+    for (long i = 0; i < batch; i++)
+    {
+        if (b->run(b->arg) == -1)
+        {
+            return -1;
+        }
+    }
+
+    return (now_ns() - start) / batch;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+-----------------------------------------------------------------
+MEASURE ONE BENCHMARK
+-----------------------------------------------------------------
+*/
+static int measure(const struct benchmark *b, double target_ms, struct result *res)
+{
+    static double samples[MAX_SAMPLES];
+    long batch = 1;
+    int n = 0;
+
+    memset(res, 0, sizeof(*res));
+    res->name = b->name;
+
+    /* Warmup + calibration: grow batch until it lasts SAMPLE_MS */
+    double warm_end = now_ns() + WARMUP_MS * 1e6;
+    double per_op;
+    do
+    {
+        per_op = run_batch(b, batch);
+        if (per_op < 0)
+        {
+            return -1;
+        }
+        if (per_op * batch < SAMPLE_MS * 1e6)
+        {
+            batch *= 2;
+        }
+    } while (now_ns() < warm_end);
+
+    long wanted = (long)(SAMPLE_MS * 1e6 / per_op);
+    batch = wanted > 1 ? wanted : 1;
+
+    /* Sampling */
+    double end = now_ns() + target_ms * 1e6;
+    while (n < MAX_SAMPLES && (now_ns() < end || n < MIN_SAMPLES))
+    {
+        samples[n] = run_batch(b, batch);
+        if (samples[n] < 0)
+        {
+            return -1;
+        }
+        n++;
+    }
+
+    /* Statistics */
+    double sum = 0, sq = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sum += samples[i];
+    }
+    res->mean = sum / n;
+    for (int i = 0; i < n; i++)
+    {
+        sq += (samples[i] - res->mean) * (samples[i] - res->mean);
+    }
+    res->stddev = n > 1 ? sqrt(sq / (n - 1)) : 0;
+
+    qsort(samples, n, sizeof(double), cmp_double);
+    res->min = samples[0];
+    res->p50 = samples[(int)(n * 0.50)];
+    res->p90 = samples[(int)(n * 0.90)];
+    res->p99 = samples[(int)(n * 0.99)];
+    res->batch = batch;
+    res->samples = n;
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+CPU MODEL FROM /proc/cpuinfo
+-----------------------------------------------------------------
+*/
+static void cpu_model(char *out, size_t len)
+{
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+    char line[512];
+
+    snprintf(out, len, "unknown");
+    if (fp == NULL)
+    {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        char *colon = strchr(line, ':');
+
+        if (strncmp(line, "model name", 10) == 0 && colon != NULL)
+        {
+            snprintf(out, len, "%s", colon + 2);
+            out[strcspn(out, "\n")] = '\0';
+            break;
+        }
+    }
+    fclose(fp);
+}
+
+/*
+-----------------------------------------------------------------
+WRITE JSON REPORT
+-----------------------------------------------------------------
+*/
+static int write_json(const char *path, const struct result *results, int count)
+{
+    struct utsname uts;
+    char model[256];
+    FILE *fp = fopen(path, "w");
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    uname(&uts);
+    cpu_model(model, sizeof(model));
+
+    fprintf(fp, "{\n  \"timestamp\": %ld,\n", (long)time(NULL));
+    fprintf(fp, "  \"kernel\": \"%s\",\n  \"machine\": \"%s\",\n", uts.release, uts.machine);
+    fprintf(fp, "  \"cpu_model\": \"%s\",\n  \"cpus\": %ld,\n", model,
+            sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(fp, "  \"unit\": \"ns/op\",\n  \"benchmarks\": [\n");
+
+    for (int i = 0; i < count; i++)
+    {
+        const struct result *r = &results[i];
+
+        fprintf(fp, "    {\"name\": \"%s\", \"batch\": %ld, \"samples\": %d, "
+                    "\"mean\": %.1f, \"stddev\": %.1f, \"min\": %.1f, "
+                    "\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f}%s\n",
+                r->name, r->batch, r->samples, r->mean, r->stddev, r->min,
+                r->p50, r->p90, r->p99, i + 1 < count ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program runs every registered microbenchmark.
+*/
+int main(int argc, char *argv[])
+{
+    const char *filter = NULL, *json_path = NULL;
+    double target_ms = 500;
+    struct result results[BENCH_COUNT];
+    int count = 0, opt;
+
+    /*
+    STEP 1: Options
+    ---------------
+    */
+    while ((opt = getopt(argc, argv, "f:t:j:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': filter = optarg; break;
+        case 't': target_ms = atof(optarg) * 1e3; break;
+        case 'j': json_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-f filter] [-t seconds] [-j results.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct utsname uts;
+    char model[256];
+    uname(&uts);
+    cpu_model(model, sizeof(model));
+    printf("Kernel %s, %s, %ld CPUs\n\n", uts.release, model, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-22s %9s %8s %11s %10s %10s %10s %10s %10s\n", "benchmark", "batch", "samples",
+           "mean ns", "stddev", "min", "p50", "p90", "p99");
+
+    /*
+    STEP 2 - 6: Run benchmarks
+    --------------------------
+    */
+    for (int i = 0; i < BENCH_COUNT; i++)
+    {
+        const struct benchmark *b = &benchmarks[i];
+        struct result *r = &results[count];
+
+        if (filter != NULL && strstr(b->name, filter) == NULL)
+        {
+            continue;
+        }
+
+        fflush(stdout);
+        if (b->setup != NULL && b->setup(b->arg) == -1)
+        {
+            perror(b->name);
+            return 1;
+        }
+        if (measure(b, target_ms, r) == -1)
+        {
+            perror(b->name);
+            if (b->teardown != NULL)
+            {
+                b->teardown();
+            }
+            return 1;
+        }
+        if (b->teardown != NULL)
+        {
+            b->teardown();
+        }
+
+        printf("%-22s %9ld %8d %11.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", r->name,
+               r->batch, r->samples, r->mean, r->stddev, r->min, r->p50, r->p90, r->p99);
+        count++;
+    }
+
+    if (json_path != NULL)
+    {
+        if (write_json(json_path, results, count) == -1)
+        {
+            perror("json write failed");
+            return 1;
+        }
+        printf("\nResults written to %s\n", json_path);
+    }
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Register each operation as { name, setup, run, teardown }
+2. Warm up before measuring
+3. Batch fast operations so one sample is ~1 ms
+4. Report per-operation mean, stddev and percentiles
+5. Percentiles show the tail that the mean hides
+6. Save JSON with kernel + CPU info to compare runs
+
+DEFINITION (IN SIMPLE WORDS):
+The harness runs each system call again and again,
+times it carefully, and writes down how fast it was
+so the numbers can be compared later.
+
+REAL-TIME EXAMPLES:
+- Kernel regression testing (lmbench, will-it-scale)
+- Google Benchmark style harnesses
+- CI performance dashboards
+- Comparing machines and kernel versions
+
+=================================================================
+*/
@@ -0,0 +1,795 @@
+/*
+=================================================================
+PIPELINED PRODUCER / CONSUMER FLOW – FILE + IPC (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How the serial combined flow becomes a streaming pipeline
+2. How a parent reads a large file in chunks and streams them
+   over a socketpair() while the child works at the same time
+3. How the child receives, transforms and writes in parallel
+4. How in-flight buffers are bounded with credits (acks)
+5. How end-to-end throughput compares with the serial flow
+6. How the overlap is shown on a timeline trace
+
+DEFINITION:
+In the serial flow (combined_syscalls.c) every stage waits
+for the previous one to finish completely. In a pipeline the
+data is cut into chunks: while the child writes chunk 1, the
+parent is already reading chunk 3. Stages overlap, so the
+total time approaches the time of the slowest stage instead
+of the sum of all stages.
+
+SYNTAX (MAJOR CALLS USED):
+ssize_t read(int fd, void *buf, size_t count);
+ssize_t send(int sockfd, const void *buf, size_t len, int flags);
+ssize_t recv(int sockfd, void *buf, size_t len, int flags);
+ssize_t write(int fd, const void *buf, size_t count);
+void   *mmap(void *addr, size_t length, int prot, int flags,
+             int fd, off_t offset);
+
+SYNTAX EXPLANATION:
+MSG_WAITALL       -> recv() waits until the full length arrived
+                     (chunk header and chunk body)
+
+struct chunk_header -> { sequence number, payload length }
+                       length 0 marks the end of the stream
+
+credit (ack)      -> Child sends 1 ack per chunk it wrote;
+                     parent never has more than WINDOW chunks
+                     unacknowledged, so memory stays bounded
+
+MAP_SHARED | MAP_ANONYMOUS
+                  -> Trace buffer visible to parent AND child
+
+KEY POINTS:
+- Parent: read() chunk -> send() header + data
+- Child : recv() chunk -> transform -> write() -> ack
+- At most WINDOW chunks are in flight at any time
+- Both processes record stage start/end times in a shared trace
+- Trace is printed as an ASCII timeline (first chunks,
+  one digit per chunk) and saved as JSON
+  (chrome://tracing / Perfetto format)
+- The serial flow is run on the same file for comparison
+
+WHY PIPELINING?
+- Disk reads, IPC and writes run at the same time
+- Bounded buffers: large files never sit fully in memory
+- Throughput limited by the slowest stage, not the sum
+
+IMPORTANT APIs:
+open()        -> Open input and output files
+read()        -> Read next chunk
+socketpair()  -> Parent-child stream
+fork()        -> Create consumer child
+send()/recv() -> Move chunks and acks
+write()       -> Write transformed chunk
+wait()        -> Wait for child to finish
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Creates the input file if it does not exist
+STEP 2: Runs the SERIAL flow: read all -> send all ->
+        receive all -> transform all -> write all
+STEP 3: Runs the PIPELINED flow with bounded credits
+STEP 4: Verifies both outputs byte for byte against the
+        transformed input
+STEP 5: Prints throughput of both flows and the speedup
+STEP 6: Prints ASCII timeline; saves a Chrome trace JSON
+        only when a trace file is given
+
+COMPILE:
+gcc -O2 pipelined_syscalls.c
+./a.out [input_file] [size_mb_if_created] [trace.json]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Serial flow time and MB/s
+2. Pipelined flow time and MB/s, speedup
+3. Timeline where read / send / recv / transform / write
+   rows overlap for the pipelined flow
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>      // For printf(), perror(), fopen()
+#include <stdlib.h>     // For malloc(), atol()
+#include <string.h>     // For memset(), memcmp()
+#include <ctype.h>      // For toupper()
+#include <fcntl.h>      // For open()
+#include <time.h>       // For clock_gettime()
+#include <unistd.h>     // For read(), write(), fork(), close()
+#include <sys/mman.h>   // For mmap()
+#include <sys/socket.h> // For socketpair(), send(), recv()
+#include <sys/stat.h>   // For fstat()
+#include <sys/types.h>  // For pid_t
+#include <sys/wait.h>   // For wait()
+
+#define CHUNK_SIZE      (256 * 1024)
+#define WINDOW          4
+#define MAX_TRACE       65536
+#define TIMELINE_COL    64
+#define TIMELINE_CHUNKS 8
+
+enum stage { ST_READ, ST_SEND, ST_RECV, ST_TRANSFORM, ST_WRITE, ST_COUNT };
+
+static const char *stage_names[ST_COUNT] = { "read", "send", "recv", "transform", "write" };
+
+/*
+Header in front of every chunk on the socket.
+*/
+struct chunk_header
+{
+    unsigned int seq;
+    unsigned int len;
+};
+
+/*
+One timed stage of one chunk.
+*/
+struct trace_event
+{
+    int    stage;
+    int    chunk;
+    double start_us;
+    double end_us;
+};
+
+/*
+Trace shared between parent and child (MAP_SHARED).
+*/
+struct trace
+{
+    int                count;
+    double             origin_us;
+    struct trace_event events[MAX_TRACE];
+};
+
+static struct trace *trace;
+
+/*
+-----------------------------------------------------------------
+NOW IN MICROSECONDS
+-----------------------------------------------------------------
+*/
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/*
+-----------------------------------------------------------------
+RECORD ONE STAGE IN THE SHARED TRACE
+-----------------------------------------------------------------
+*/
+static void trace_add(int stage, int chunk, double start_us)
+{
+    if (trace == NULL)
+    {
+        return;
+    }
+
+    int slot = __atomic_fetch_add(&trace->count, 1, __ATOMIC_RELAXED);
+    if (slot < MAX_TRACE)
+    {
+        trace->events[slot].stage = stage;
+        trace->events[slot].chunk = chunk;
+        trace->events[slot].start_us = start_us - trace->origin_us;
+        trace->events[slot].end_us = now_us() - trace->origin_us;
+    }
+}
+
+/*
+-----------------------------------------------------------------
+FULL WRITE / FULL SEND / FULL READ HELPERS
+-----------------------------------------------------------------
+*/
+static int write_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, buf, len);
+
+        if (n <= 0)
+        {
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int send_all(int sock, const void *buf, size_t len)
+{
+    const char *p = buf;
+
+    while (len > 0)
+    {
+        ssize_t n = send(sock, p, len, 0);
+
+        if (n <= 0)
+        {
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static ssize_t read_full(int fd, char *buf, size_t len)
+{
+    size_t got = 0;
+
+    while (got < len)
+    {
+        ssize_t n = read(fd, buf + got, len - got);
+
+        if (n < 0)
+        {
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        got += n;
+    }
+    return (ssize_t)got;
+}
+
+/*
+-----------------------------------------------------------------
+TRANSFORM: LOWER CASE -> UPPER CASE
+-----------------------------------------------------------------
+*/
+static void transform(char *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = (char)toupper((unsigned char)buf[i]);
+    }
+}
+
+/*
+-----------------------------------------------------------------
+CREATE INPUT FILE
+-----------------------------------------------------------------
+*/
+static int create_input(const char *path, long size_mb)
+{
+    static char block[1024 * 1024];
+    size_t used = 0;
+    unsigned long line = 0;
+
+    int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    while (used < sizeof(block) - 64)
+    {
+        used += snprintf(block + used, sizeof(block) - used, "hello pipeline line %lu\n", line++);
+    }
+    for (long i = 0; i < size_mb; i++)
+    {
+        if (write_all(fd, block, used) == -1)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+SERIAL FLOW (ONE STAGE AFTER ANOTHER)
+-----------------------------------------------------------------
+Returns elapsed microseconds or -1.
+*/
+static double serial_flow(const char *in_path, const char *out_path, size_t size)
+{
+    int sv[2];
+    double start = now_us();
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+    {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        return -1;
+    }
+    if (pid == 0)
+    {
+        /* CHILD: receive everything, then transform, then write */
+        char *buf = malloc(size);
+        close(sv[0]);
+        if (buf == NULL || recv(sv[1], buf, size, MSG_WAITALL) != (ssize_t)size)
+        {
+            _exit(1);
+        }
+        transform(buf, size);
+
+        int out = open(out_path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+        if (out == -1 || write_all(out, buf, size) == -1)
+        {
+            _exit(1);
+        }
+        close(out);
+        _exit(0);
+    }
+
+    /* PARENT: read everything, then send everything */
+    close(sv[1]);
+    char *buf = malloc(size);
+    int in = open(in_path, O_RDONLY);
+    if (buf == NULL || in == -1 || read_full(in, buf, size) != (ssize_t)size)
+    {
+        return -1;
+    }
+    close(in);
+
+    if (send_all(sv[0], buf, size) == -1)
+    {
+        return -1;
+    }
+    close(sv[0]);
+    free(buf);
+
+    int status;
+    wait(&status);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        return -1;
+    }
+
+    return now_us() - start;
+}
+
+/*
+-----------------------------------------------------------------
+PIPELINED CONSUMER (CHILD)
+-----------------------------------------------------------------
+recv -> transform -> write -> ack, chunk by chunk.
+*/
+static void pipeline_consumer(int sock, const char *out_path)
+{
+    static char buf[CHUNK_SIZE];
+    struct chunk_header hdr;
+
+    int out = open(out_path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (out == -1)
+    {
+        _exit(1);
+    }
+
+    for (;;)
+    {
+        double t = now_us();
+
+        if (recv(sock, &hdr, sizeof(hdr), MSG_WAITALL) != sizeof(hdr))
+        {
+            _exit(1);
+        }
+        if (hdr.len == 0)
+        {
+            break;
+        }
+        if (hdr.len > CHUNK_SIZE || recv(sock, buf, hdr.len, MSG_WAITALL) != (ssize_t)hdr.len)
+        {
+            _exit(1);
+        }
+        trace_add(ST_RECV, hdr.seq, t);
+
+        t = now_us();
+        transform(buf, hdr.len);
+        trace_add(ST_TRANSFORM, hdr.seq, t);
+
+        t = now_us();
+        if (write_all(out, buf, hdr.len) == -1)
+        {
+            _exit(1);
+        }
+        trace_add(ST_WRITE, hdr.seq, t);
+
+        /* Return one credit to the producer */
+        if (send(sock, &hdr.seq, sizeof(hdr.seq), 0) != sizeof(hdr.seq))
+        {
+            _exit(1);
+        }
+    }
+
+    close(out);
+    _exit(0);
+}
+
+/*
+-----------------------------------------------------------------
+PIPELINED FLOW
+-----------------------------------------------------------------
+Producer keeps at most WINDOW chunks without an ack.
+Returns elapsed microseconds or -1.
+*/
+static double pipelined_flow(const char *in_path, const char *out_path)
+{
+    static char bufs[WINDOW][CHUNK_SIZE];
+    int sv[2];
+
+    trace->count = 0;
+    trace->origin_us = now_us();
+    double start = trace->origin_us;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+    {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        return -1;
+    }
+    if (pid == 0)
+    {
+        close(sv[0]);
+        pipeline_consumer(sv[1], out_path);
+    }
+    close(sv[1]);
+
+    int in = open(in_path, O_RDONLY);
+    if (in == -1)
+    {
+        return -1;
+    }
+
+    unsigned int seq = 0, acked = 0;
+    for (;;)
+    {
+        /* Wait for a credit when the window is full */
+        while (seq - acked >= WINDOW)
+        {
+            unsigned int ack;
+
+            if (recv(sv[0], &ack, sizeof(ack), MSG_WAITALL) != sizeof(ack))
+            {
+                return -1;
+            }
+            acked++;
+        }
+
+        char *buf = bufs[seq % WINDOW];
+        double t = now_us();
+        ssize_t n = read_full(in, buf, CHUNK_SIZE);
+        if (n < 0)
+        {
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        trace_add(ST_READ, seq, t);
+
+        struct chunk_header hdr = { seq, (unsigned int)n };
+        t = now_us();
+        if (send_all(sv[0], &hdr, sizeof(hdr)) == -1 || send_all(sv[0], buf, n) == -1)
+        {
+            return -1;
+        }
+        trace_add(ST_SEND, seq, t);
+        seq++;
+    }
+    close(in);
+
+    /* End of stream, then drain remaining acks */
+    struct chunk_header end = { seq, 0 };
+    send_all(sv[0], &end, sizeof(end));
+    while (acked < seq)
+    {
+        unsigned int ack;
+
+        if (recv(sv[0], &ack, sizeof(ack), MSG_WAITALL) != sizeof(ack))
+        {
+            return -1;
+        }
+        acked++;
+    }
+    close(sv[0]);
+
+    int status;
+    wait(&status);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        return -1;
+    }
+
+    return now_us() - start;
+}
+
+/*
+-----------------------------------------------------------------
+PRINT ASCII TIMELINE
+-----------------------------------------------------------------
+One row per stage for the first TIMELINE_CHUNKS chunks.
+Each busy column shows the chunk number, so the same digit
+in different rows at different times shows the overlap.
+*/
+static void print_timeline(void)
+{
+    int events = trace->count < MAX_TRACE ? trace->count : MAX_TRACE;
+    double span = 0;
+
+    for (int i = 0; i < events; i++)
+    {
+        if (trace->events[i].chunk < TIMELINE_CHUNKS && trace->events[i].end_us > span)
+        {
+            span = trace->events[i].end_us;
+        }
+    }
+    if (span <= 0)
+    {
+        return;
+    }
+
+    printf("\nTimeline (first %d chunks, %d columns = %.2f ms):\n",
+           TIMELINE_CHUNKS, TIMELINE_COL, span / 1e3);
+    for (int s = 0; s < ST_COUNT; s++)
+    {
+        char row[TIMELINE_COL + 1];
+
+        memset(row, '.', TIMELINE_COL);
+        row[TIMELINE_COL] = '\0';
+
+        for (int i = 0; i < events; i++)
+        {
+            struct trace_event *e = &trace->events[i];
+
+            if (e->stage != s || e->chunk >= TIMELINE_CHUNKS)
+            {
+                continue;
+            }
+            int a = (int)(e->start_us / span * TIMELINE_COL);
+            int b = (int)(e->end_us / span * TIMELINE_COL);
+            for (int c = a; c <= b && c < TIMELINE_COL; c++)
+            {
+                row[c] = (char)('0' + e->chunk % 10);
+            }
+        }
+        printf("  %-10s |%s|\n", stage_names[s], row);
+    }
+}
+
+/*
+-----------------------------------------------------------------
+VERIFY BOTH OUTPUTS AGAINST THE TRANSFORMED INPUT
+-----------------------------------------------------------------
+Reads input and both outputs in step, chunk by chunk, and
+compares every byte: a reordered or misplaced chunk fails even
+when the sizes match. Returns 0 if all three agree.
+*/
+static int verify_outputs(const char *in_path, const char *a_path, const char *b_path)
+{
+    static char in[CHUNK_SIZE], a[CHUNK_SIZE], b[CHUNK_SIZE];
+    int fd_in = open(in_path, O_RDONLY);
+    int fd_a = open(a_path, O_RDONLY);
+    int fd_b = open(b_path, O_RDONLY);
+    off_t offset = 0;
+    int rc = -1;
+
+    if (fd_in != -1 && fd_a != -1 && fd_b != -1)
+    {
+        for (;;)
+        {
+            ssize_t n = read_full(fd_in, in, CHUNK_SIZE);
+            ssize_t na = read_full(fd_a, a, CHUNK_SIZE);
+            ssize_t nb = read_full(fd_b, b, CHUNK_SIZE);
+
+            if (n < 0 || n != na || n != nb)
+            {
+                fprintf(stderr, "output length mismatch near offset %lld\n", (long long)offset);
+                break;
+            }
+            if (n == 0)
+            {
+                rc = 0;
+                break;
+            }
+
+            transform(in, n);
+            if (memcmp(in, a, n) != 0 || memcmp(in, b, n) != 0)
+            {
+                fprintf(stderr, "output content mismatch in chunk at offset %lld\n",
+                        (long long)offset);
+                break;
+            }
+            offset += n;
+        }
+    }
+
+    if (fd_in != -1)
+    {
+        close(fd_in);
+    }
+    if (fd_a != -1)
+    {
+        close(fd_a);
+    }
+    if (fd_b != -1)
+    {
+        close(fd_b);
+    }
+    return rc;
+}
+
+/*
+-----------------------------------------------------------------
+SAVE TRACE AS CHROME TRACE JSON
+-----------------------------------------------------------------
+*/
+static int save_trace_json(const char *path)
+{
+    int events = trace->count < MAX_TRACE ? trace->count : MAX_TRACE;
+    FILE *fp = fopen(path, "w");
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (int i = 0; i < events; i++)
+    {
+        struct trace_event *e = &trace->events[i];
+        int tid = e->stage <= ST_SEND ? 1 : 2;
+
+        fprintf(fp, "%s{\"name\":\"%s %d\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.1f,"
+                    "\"dur\":%.1f,\"pid\":1,\"tid\":%d}",
+                i ? ",\n" : "", stage_names[e->stage], e->chunk, stage_names[e->stage],
+                e->start_us, e->end_us - e->start_us, tid);
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares the serial file + IPC flow with a
+pipelined producer/consumer flow.
+*/
+int main(int argc, char *argv[])
+{
+    const char *in_path = argc > 1 ? argv[1] : "x.txt";
+    long size_mb = argc > 2 ? atol(argv[2]) : 256;
+    const char *trace_path = argc > 3 ? argv[3] : NULL;
+    struct stat st;
+
+    /*
+    STEP 1: Create input if needed
+    ------------------------------
+    */
+    if (access(in_path, F_OK) == -1)
+    {
+        printf("Creating %s (%ld MB)...\n", in_path, size_mb);
+        if (create_input(in_path, size_mb) == -1)
+        {
+            perror("create failed");
+            return 1;
+        }
+    }
+    if (stat(in_path, &st) == -1)
+    {
+        perror("stat failed");
+        return 1;
+    }
+    size_t size = st.st_size;
+
+    trace = mmap(NULL, sizeof(struct trace), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (trace == MAP_FAILED)
+    {
+        perror("mmap failed");
+        return 1;
+    }
+
+    /*
+    STEP 2: Serial flow
+    -------------------
+    */
+    double serial_us = serial_flow(in_path, "x_serial_out.txt", size);
+    if (serial_us < 0)
+    {
+        perror("serial flow failed");
+        return 1;
+    }
+
+    /*
+    STEP 3: Pipelined flow
+    ----------------------
+    */
+    double pipe_us = pipelined_flow(in_path, "x_pipelined_out.txt");
+    if (pipe_us < 0)
+    {
+        perror("pipelined flow failed");
+        return 1;
+    }
+
+    /*
+    STEP 4: Verify output contents
+    ------------------------------
+    */
+    if (verify_outputs(in_path, "x_serial_out.txt", "x_pipelined_out.txt") == -1)
+    {
+        fprintf(stderr, "verification failed\n");
+        unlink("x_serial_out.txt");
+        unlink("x_pipelined_out.txt");
+        return 1;
+    }
+
+    /*
+    STEP 5: Throughput
+    ------------------
+    */
+    printf("Input        : %s, %.1f MB, chunk %d KB, window %d\n",
+           in_path, size / 1048576.0, CHUNK_SIZE / 1024, WINDOW);
+    printf("Serial flow  : %8.1f ms  %8.1f MB/s\n", serial_us / 1e3, size / serial_us);
+    printf("Pipelined    : %8.1f ms  %8.1f MB/s  (%.2fx)\n", pipe_us / 1e3, size / pipe_us,
+           serial_us / pipe_us);
+
+    /*
+    STEP 6: Timeline trace
+    ----------------------
+    */
+    print_timeline();
+    if (trace_path != NULL && save_trace_json(trace_path) == 0)
+    {
+        printf("\nTrace saved to %s (open in chrome://tracing)\n", trace_path);
+    }
+
+    unlink("x_serial_out.txt");
+    unlink("x_pipelined_out.txt");
+    munmap(trace, sizeof(struct trace));
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Serial flow: total time = sum of all stages
+2. Pipeline: cut data into chunks, stages overlap
+3. Parent produces (read + send), child consumes
+   (recv + transform + write)
+4. Credits (acks) bound the number of in-flight chunks
+5. MSG_WAITALL receives a whole header / chunk
+6. Shared anonymous mmap collects a trace from both processes
+7. Timeline rows overlap = stages run at the same time
+
+DEFINITION (IN SIMPLE WORDS):
+Instead of finishing one job before starting the
+next, the parent and child work on different pieces
+of the file at the same time, like an assembly line.
+
+REAL-TIME EXAMPLES:
+- Shell pipelines (cat | tr | tee)
+- File copy and compression tools
+- Streaming ETL / log shipping
+- Video transcoding pipelines
+
+=================================================================
+*/
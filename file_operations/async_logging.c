@@ -0,0 +1,707 @@
+/*
+=================================================================
+ASYNCHRONOUS LOGGING – LOCK-FREE MPSC QUEUE + WRITER THREAD
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How application threads log without calling write() themselves
+2. How a lock-free multi-producer / single-consumer (MPSC) queue
+   of preallocated slots works
+3. How one writer thread drains the queue in batches with
+   pwritev2() (one syscall for many records)
+4. How overflow is handled: block, drop or spill
+5. How the memory budget bounds the queue size
+6. How producer-side latency is measured with histograms
+
+DEFINITION:
+In write.c the caller waits for write() to finish. Here a
+producer thread only copies its record into a free slot of a
+ring buffer and returns. A dedicated writer thread collects
+many ready slots and writes them with a single pwritev2()
+call. Slots are claimed with an atomic compare-and-swap, so
+producers never take a lock.
+
+SYNTAX (MAJOR CALLS USED):
+int     pthread_create(pthread_t *t, const pthread_attr_t *attr,
+                       void *(*fn)(void *), void *arg);
+ssize_t pwritev2(int fd, const struct iovec *iov, int iovcnt,
+                 off_t offset, int flags);
+long    syscall(SYS_futex, int *uaddr, int op, int val, ...);
+
+SYNTAX EXPLANATION:
+struct slot       -> { sequence number, length, data[] }
+sequence          -> Tells whose turn the slot is:
+                     seq == pos      -> free for producer at pos
+                     seq == pos + 1  -> filled, ready for writer
+
+__atomic_compare_exchange_n()
+                  -> Producers race for the next position;
+                     exactly one wins each slot
+
+pwritev2(..., -1, 0)
+                  -> offset -1 = use and advance file position
+                     (like writev) with optional RWF_* flags
+
+FUTEX_WAIT / FUTEX_WAKE
+                  -> Idle writer sleeps; a producer wakes it only
+                     if it is sleeping and the queue is half full
+
+OVERFLOW POLICIES (queue full):
+BLOCK  -> Producer waits (yields) until a slot is free
+DROP   -> Record is discarded and counted
+SPILL  -> Record is written directly to a spill file
+
+KEY POINTS:
+- Slots are preallocated: no malloc() on the log path
+- Queue capacity = memory budget / slot size (power of two)
+- Writer builds an iovec that points INTO the slots (no copy)
+- Slots are released only after pwritev2() returned
+- Records longer than a slot are truncated
+- Idle writer wakes every FLUSH_INTERVAL_NS, or earlier when
+  a producer finds the queue half full
+- Per-producer histograms: no sharing on the hot path
+
+WHY ASYNC LOGGING?
+- Application threads never block on disk I/O
+- Batching turns thousands of writes into a few syscalls
+- Explicit overflow policy instead of unbounded memory
+
+IMPORTANT APIs:
+pthread_create()  -> Producer and writer threads
+pwritev2()        -> Batched write
+futex()           -> Sleep / wake writer
+open(), close()   -> Log and spill files
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Baseline: producers call write() directly on the log
+STEP 2: For each policy (block, drop, spill):
+        a) creates the logger with a small memory budget
+        b) starts the writer thread
+        c) producers log records through the queue
+        d) logger is flushed and stopped
+STEP 3: Prints written / dropped / spilled records, batches,
+        and producer latency percentiles for every run
+
+COMPILE:
+gcc -O2 -pthread async_logging.c
+./a.out [producers] [records_per_producer] [budget_kb]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. One row per mode: sync write(), block, drop, spill
+2. Records written/dropped/spilled, average batch size
+3. Producer latency p50 / p99 / p99.9 / max in ns
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>         // For printf(), snprintf(), perror()
+#include <stdlib.h>        // For calloc(), free(), atoi()
+#include <string.h>        // For memcpy(), memset()
+#include <errno.h>         // For errno
+#include <fcntl.h>         // For open()
+#include <pthread.h>       // For pthread_create(), pthread_join()
+#include <sched.h>         // For sched_yield()
+#include <time.h>          // For clock_gettime()
+#include <unistd.h>        // For write(), close(), syscall(), unlink()
+#include <linux/futex.h>   // For FUTEX_WAIT, FUTEX_WAKE
+#include <sys/syscall.h>   // For SYS_futex
+#include <sys/uio.h>       // For pwritev2(), struct iovec
+
+#define LOG_FILE          "async_logging.log"
+#define SPILL_FILE        "async_logging.log.spill"
+#define SLOT_DATA         116
+#define BATCH_MAX         256
+#define FLUSH_INTERVAL_NS 1000000L
+#define SUB_BITS          3
+#define SUB_COUNT         (1 << SUB_BITS)
+#define BUCKETS           ((64 - SUB_BITS + 1) * SUB_COUNT)
+
+enum overflow_policy { POLICY_BLOCK, POLICY_DROP, POLICY_SPILL };
+
+static const char *policy_names[] = { "block", "drop", "spill" };
+
+/*
+One preallocated queue slot (128 bytes).
+*/
+struct slot
+{
+    unsigned long seq;
+    unsigned int  len;
+    char          data[SLOT_DATA];
+};
+
+/*
+Logger: bounded MPSC ring + writer thread state.
+*/
+struct logger
+{
+    struct slot          *slots;
+    unsigned long         mask;
+    unsigned long         enqueue_pos __attribute__((aligned(64)));
+    unsigned long         dequeue_pos __attribute__((aligned(64)));
+    int                   writer_sleeping __attribute__((aligned(64)));
+    int                   stop;
+    int                   fd;
+    int                   spill_fd;
+    enum overflow_policy  policy;
+    pthread_t             writer;
+    unsigned long         written;
+    unsigned long         dropped;
+    unsigned long         spilled;
+    unsigned long         batches;
+};
+
+/*
+Log-linear latency histogram of one producer.
+*/
+struct histogram
+{
+    unsigned long count;
+    unsigned long max_ns;
+    unsigned int  buckets[BUCKETS];
+};
+
+/*
+Arguments of one producer thread.
+*/
+struct producer
+{
+    pthread_t        thread;
+    int              id;
+    int              records;
+    struct logger   *log;      /* NULL = synchronous write() baseline */
+    int              sync_fd;
+    struct histogram hist;
+};
+
+/*
+-----------------------------------------------------------------
+CLOCK IN NANOSECONDS
+-----------------------------------------------------------------
+*/
+static inline unsigned long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+/*
+-----------------------------------------------------------------
+HISTOGRAM HELPERS (LOG-LINEAR, 8 SUB-BUCKETS)
+-----------------------------------------------------------------
+*/
+static inline void hist_add(struct histogram *h, unsigned long v)
+{
+    int b;
+
+    if (v < SUB_COUNT)
+    {
+        b = (int)v;
+    }
+    else
+    {
+        int exp = 63 - __builtin_clzl(v);
+        b = (exp - SUB_BITS + 1) * SUB_COUNT + (int)((v >> (exp - SUB_BITS)) & (SUB_COUNT - 1));
+    }
+    h->buckets[b]++;
+    h->count++;
+    if (v > h->max_ns)
+    {
+        h->max_ns = v;
+    }
+}
+
+static unsigned long bucket_low(int b)
+{
+    if (b < SUB_COUNT)
+    {
+        return (unsigned long)b;
+    }
+    int exp = b / SUB_COUNT + SUB_BITS - 1;
+    return (unsigned long)(SUB_COUNT + b % SUB_COUNT) << (exp - SUB_BITS);
+}
+
+/* Highest value that still falls into bucket b */
+static unsigned long bucket_high(int b)
+{
+    if (b + 1 >= BUCKETS)
+    {
+        return ~0UL;
+    }
+    return bucket_low(b + 1) - 1;
+}
+
+/*
+Reports the highest value of the bucket (never below the true
+value), clamped to the largest sample seen.
+*/
+static unsigned long hist_percentile(const struct histogram *h, double p)
+{
+    unsigned long target = (unsigned long)(h->count * p), seen = 0;
+
+    for (int b = 0; b < BUCKETS; b++)
+    {
+        seen += h->buckets[b];
+        if (seen > target)
+        {
+            unsigned long high = bucket_high(b);
+            return high < h->max_ns ? high : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+static void hist_merge(struct histogram *dst, const struct histogram *src)
+{
+    dst->count += src->count;
+    if (src->max_ns > dst->max_ns)
+    {
+        dst->max_ns = src->max_ns;
+    }
+    for (int b = 0; b < BUCKETS; b++)
+    {
+        dst->buckets[b] += src->buckets[b];
+    }
+}
+
+/*
+-----------------------------------------------------------------
+FUTEX WAIT / WAKE
+-----------------------------------------------------------------
+*/
+static void futex_wait(int *addr, int expected, long timeout_ns)
+{
+    struct timespec ts = { 0, timeout_ns };
+
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, &ts, NULL, 0);
+}
+
+static void futex_wake(int *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/*
+-----------------------------------------------------------------
+WRITER THREAD
+-----------------------------------------------------------------
+Collects up to BATCH_MAX ready slots, writes them with one
+pwritev2(), then hands the slots back to producers.
+*/
+static void *writer_main(void *arg)
+{
+    struct logger *log = arg;
+    struct iovec iov[BATCH_MAX];
+
+    for (;;)
+    {
+        unsigned long pos = log->dequeue_pos;
+        int n = 0;
+
+        while (n < BATCH_MAX)
+        {
+            struct slot *s = &log->slots[(pos + n) & log->mask];
+
+            if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != pos + n + 1)
+            {
+                break;
+            }
+            iov[n].iov_base = s->data;
+            iov[n].iov_len = s->len;
+            n++;
+        }
+
+        if (n == 0)
+        {
+            if (__atomic_load_n(&log->stop, __ATOMIC_ACQUIRE))
+            {
+                break;
+            }
+            /* Announce sleep, re-check, then wait (flush interval max) */
+            __atomic_store_n(&log->writer_sleeping, 1, __ATOMIC_SEQ_CST);
+            struct slot *s = &log->slots[pos & log->mask];
+            if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != pos + 1)
+            {
+                futex_wait(&log->writer_sleeping, 1, FLUSH_INTERVAL_NS);
+            }
+            __atomic_store_n(&log->writer_sleeping, 0, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        /* Write batch completely (handles partial writes) */
+        struct iovec *v = iov;
+        int left = n;
+        while (left > 0)
+        {
+            ssize_t w = pwritev2(log->fd, v, left, -1, 0);
+
+            if (w == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                perror("pwritev2 failed");
+                break;
+            }
+            while (left > 0 && (size_t)w >= v->iov_len)
+            {
+                w -= v->iov_len;
+                v++;
+                left--;
+            }
+            if (left > 0)
+            {
+                v->iov_base = (char *)v->iov_base + w;
+                v->iov_len -= w;
+            }
+        }
+
+        /* Release slots: next lap's producer may use them */
+        for (int i = 0; i < n; i++)
+        {
+            struct slot *s = &log->slots[(pos + i) & log->mask];
+            __atomic_store_n(&s->seq, pos + i + log->mask + 1, __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(&log->dequeue_pos, pos + n, __ATOMIC_RELEASE);
+        log->written += n;
+        log->batches++;
+    }
+
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+QUEUE CAPACITY FOR A MEMORY BUDGET
+-----------------------------------------------------------------
+Largest power of two number of slots that fits the budget.
+*/
+static unsigned long capacity_for_budget(size_t budget_bytes)
+{
+    unsigned long capacity = 2;
+
+    while (capacity * 2 * sizeof(struct slot) <= budget_bytes)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/*
+-----------------------------------------------------------------
+CREATE LOGGER
+-----------------------------------------------------------------
+*/
+static int logger_init(struct logger *log, const char *path, size_t budget_bytes,
+                       enum overflow_policy policy)
+{
+    unsigned long capacity = capacity_for_budget(budget_bytes);
+
+    memset(log, 0, sizeof(*log));
+
+    log->slots = calloc(capacity, sizeof(struct slot));
+    if (log->slots == NULL)
+    {
+        return -1;
+    }
+    for (unsigned long i = 0; i < capacity; i++)
+    {
+        log->slots[i].seq = i;
+    }
+    log->mask = capacity - 1;
+    log->policy = policy;
+    log->spill_fd = -1;
+
+    log->fd = open(path, O_CREAT | O_WRONLY | O_TRUNC | O_APPEND, 0644);
+    if (log->fd == -1)
+    {
+        return -1;
+    }
+    if (policy == POLICY_SPILL)
+    {
+        log->spill_fd = open(SPILL_FILE, O_CREAT | O_WRONLY | O_TRUNC | O_APPEND, 0644);
+        if (log->spill_fd == -1)
+        {
+            return -1;
+        }
+    }
+
+    return pthread_create(&log->writer, NULL, writer_main, log) == 0 ? 0 : -1;
+}
+
+/*
+-----------------------------------------------------------------
+LOG ONE RECORD (PRODUCER SIDE, LOCK-FREE)
+-----------------------------------------------------------------
+Returns 0 when queued or spilled, -1 when dropped.
+*/
+static int logger_log(struct logger *log, const char *msg, unsigned int len)
+{
+    unsigned long pos = __atomic_load_n(&log->enqueue_pos, __ATOMIC_RELAXED);
+    struct slot *s;
+
+    if (len > SLOT_DATA)
+    {
+        len = SLOT_DATA;
+    }
+
+    for (;;)
+    {
+        s = &log->slots[pos & log->mask];
+        unsigned long seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        long diff = (long)(seq - pos);
+
+        if (diff == 0)
+        {
+            /* Slot is free at this position: try to claim it */
+            if (__atomic_compare_exchange_n(&log->enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Queue is full */
+            if (log->policy == POLICY_DROP)
+            {
+                __atomic_fetch_add(&log->dropped, 1, __ATOMIC_RELAXED);
+                return -1;
+            }
+            if (log->policy == POLICY_SPILL)
+            {
+                __atomic_fetch_add(&log->spilled, 1, __ATOMIC_RELAXED);
+                return write(log->spill_fd, msg, len) == (ssize_t)len ? 0 : -1;
+            }
+            futex_wake(&log->writer_sleeping);
+            sched_yield();
+            pos = __atomic_load_n(&log->enqueue_pos, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            pos = __atomic_load_n(&log->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(s->data, msg, len);
+    s->len = len;
+    __atomic_store_n(&s->seq, pos + 1, __ATOMIC_RELEASE);
+
+    /*
+    Wake a sleeping writer only when the queue is half full;
+    otherwise it picks the records up within FLUSH_INTERVAL_NS.
+    This keeps futex calls off the common path and lets
+    batches grow.
+    */
+    unsigned long queued = pos + 1 - __atomic_load_n(&log->dequeue_pos, __ATOMIC_RELAXED);
+    if (queued > log->mask / 2 && __atomic_load_n(&log->writer_sleeping, __ATOMIC_SEQ_CST))
+    {
+        __atomic_store_n(&log->writer_sleeping, 0, __ATOMIC_SEQ_CST);
+        futex_wake(&log->writer_sleeping);
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+STOP LOGGER (DRAINS QUEUE FIRST)
+-----------------------------------------------------------------
+*/
+static void logger_stop(struct logger *log)
+{
+    __atomic_store_n(&log->stop, 1, __ATOMIC_RELEASE);
+    futex_wake(&log->writer_sleeping);
+    pthread_join(log->writer, NULL);
+
+    fdatasync(log->fd);
+    close(log->fd);
+    if (log->spill_fd != -1)
+    {
+        close(log->spill_fd);
+    }
+    free(log->slots);
+}
+
+/*
+-----------------------------------------------------------------
+PRODUCER THREAD
+-----------------------------------------------------------------
+Times every log call; with log == NULL it calls write() itself.
+*/
+static void *producer_main(void *arg)
+{
+    struct producer *p = arg;
+    char msg[SLOT_DATA];
+
+    for (int i = 0; i < p->records; i++)
+    {
+        int len = snprintf(msg, sizeof(msg), "thread %d record %d: the quick brown fox\n",
+                           p->id, i);
+        unsigned long start = now_ns();
+
+        if (p->log != NULL)
+        {
+            logger_log(p->log, msg, len);
+        }
+        else if (write(p->sync_fd, msg, len) != len)
+        {
+            perror("write failed");
+        }
+        hist_add(&p->hist, now_ns() - start);
+    }
+
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+RUN ONE MODE AND PRINT A ROW
+-----------------------------------------------------------------
+policy < 0 runs the synchronous write() baseline.
+*/
+static int run_mode(int policy, int producers, int records, size_t budget)
+{
+    struct producer *p = calloc(producers, sizeof(struct producer));
+    struct histogram all;
+    struct logger log;
+    int sync_fd = -1;
+
+    if (p == NULL)
+    {
+        return -1;
+    }
+    memset(&all, 0, sizeof(all));
+
+    if (policy < 0)
+    {
+        sync_fd = open(LOG_FILE, O_CREAT | O_WRONLY | O_TRUNC | O_APPEND, 0644);
+        if (sync_fd == -1)
+        {
+            return -1;
+        }
+    }
+    else if (logger_init(&log, LOG_FILE, budget, (enum overflow_policy)policy) == -1)
+    {
+        return -1;
+    }
+
+    unsigned long start = now_ns();
+    for (int i = 0; i < producers; i++)
+    {
+        p[i].id = i;
+        p[i].records = records;
+        p[i].log = policy < 0 ? NULL : &log;
+        p[i].sync_fd = sync_fd;
+        pthread_create(&p[i].thread, NULL, producer_main, &p[i]);
+    }
+    for (int i = 0; i < producers; i++)
+    {
+        pthread_join(p[i].thread, NULL);
+        hist_merge(&all, &p[i].hist);
+    }
+    double produce_ms = (now_ns() - start) / 1e6;
+
+    unsigned long written, dropped = 0, spilled = 0, batches = 0;
+    if (policy < 0)
+    {
+        written = (unsigned long)producers * records;
+        batches = written;
+        close(sync_fd);
+    }
+    else
+    {
+        logger_stop(&log);
+        written = log.written;
+        dropped = log.dropped;
+        spilled = log.spilled;
+        batches = log.batches;
+    }
+
+    printf("%-8s %10.1f %9lu %8lu %8lu %9.1f %8lu %8lu %8lu %10lu\n",
+           policy < 0 ? "sync" : policy_names[policy], produce_ms, written, dropped, spilled,
+           batches ? (double)written / batches : 0.0, hist_percentile(&all, 0.50),
+           hist_percentile(&all, 0.99), hist_percentile(&all, 0.999), all.max_ns);
+
+    free(p);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares synchronous write() logging with the
+asynchronous logger under each overflow policy.
+*/
+int main(int argc, char *argv[])
+{
+    int producers = argc > 1 ? atoi(argv[1]) : 4;
+    int records = argc > 2 ? atoi(argv[2]) : 200000;
+    size_t budget = (size_t)(argc > 3 ? atoi(argv[3]) : 256) * 1024;
+
+    if (producers <= 0 || records <= 0)
+    {
+        fprintf(stderr, "usage: %s [producers] [records_per_producer] [budget_kb]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d producers x %d records, budget %zu KB (%lu slots of %zu B)\n\n", producers,
+           records, budget / 1024, capacity_for_budget(budget), sizeof(struct slot));
+    printf("%-8s %10s %9s %8s %8s %9s %8s %8s %8s %10s\n", "mode", "produce ms", "written",
+           "dropped", "spilled", "avg batch", "p50 ns", "p99 ns", "p999 ns", "max ns");
+
+    /*
+    STEP 1 + 2: Baseline, then every policy
+    ---------------------------------------
+    */
+    for (int policy = -1; policy <= POLICY_SPILL; policy++)
+    {
+        fflush(stdout);
+        if (run_mode(policy, producers, records, budget) == -1)
+        {
+            perror("run failed");
+            unlink(LOG_FILE);
+            unlink(SPILL_FILE);
+            return 1;
+        }
+    }
+
+    unlink(LOG_FILE);
+    unlink(SPILL_FILE);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Producers copy records into preallocated slots, no write()
+2. Slot sequence numbers make the ring lock-free
+3. CAS on enqueue_pos: each slot has exactly one producer
+4. Single writer thread: no CAS needed on the consumer side
+5. pwritev2() writes a whole batch with one system call
+6. Full queue: block, drop or spill (explicit policy)
+7. Memory budget fixes the number of slots
+8. Measure latency where it matters: in the producer
+
+DEFINITION (IN SIMPLE WORDS):
+Threads drop their log lines into a mailbox and go
+back to work; one helper thread empties the mailbox
+and writes everything to the file in big batches.
+
+REAL-TIME EXAMPLES:
+- spdlog / log4j2 async loggers
+- Trading system journals
+- Database log writers
+- Telemetry and tracing agents
+
+=================================================================
+*/
@@ -0,0 +1,548 @@
+/*
+=================================================================
+BUFFERED WRITER – FILE OPERATIONS (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. Why many small write() calls are slow
+2. How a user-space buffer turns many records into one write
+3. How flush policies work: on size, on interval, on newline
+4. How writev() sends buffered data + a large record together
+5. How an explicit flush and a durability hook (fdatasync) work
+6. How syscalls/sec and throughput compare with raw write()
+
+DEFINITION:
+Every write() is a system call: a switch into the kernel and
+back. Writing a 32-byte log line with one write() each spends
+most of the time on that switch. A buffered writer copies
+records into a memory buffer and calls the kernel only when
+a flush policy says so, so one system call carries hundreds
+of records.
+
+SYNTAX (MAJOR CALLS USED):
+int     posix_memalign(void **memptr, size_t alignment, size_t size);
+ssize_t write(int fd, const void *buf, size_t count);
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt);
+int     fdatasync(int fd);
+
+SYNTAX EXPLANATION:
+struct buffered_writer
+                  -> fd, aligned buffer, fill level, policy,
+                     flush interval, durability hook
+
+FLUSH_ON_SIZE     -> Flush when the buffer is full
+FLUSH_ON_INTERVAL -> Flush when interval has passed since the
+                     last flush; checked on every append AND by
+                     bw_tick(), which an idle writer must call
+                     (e.g. from its poll() / timer loop)
+
+bw_timeout_ms()   -> ms until the pending data is due (-1 = none),
+                     a ready-made poll() timeout
+FLUSH_ON_NEWLINE  -> Flush after a record that ends with '\n'
+
+writev()          -> Buffer contents and a record that does not
+                     fit are written with ONE call, no extra copy
+
+durability hook   -> Function called by bw_sync() after flushing,
+                     e.g. fdatasync() to reach stable storage
+
+KEY POINTS:
+- Buffer is page aligned (posix_memalign)
+- Records that fit are copied into the buffer
+- Records that do not fit go out with writev() next to the buffer
+- bw_flush() pushes data to the kernel (page cache)
+- bw_tick() flushes an idle buffer once the interval is over
+- bw_sync() = bw_flush() + durability hook (disk)
+- bw_close() flushes, then closes the fd
+- Partial writes are handled (loop until all bytes written)
+
+WHY A BUFFERED WRITER?
+- Fewer system calls = much higher throughput
+- Policies trade latency (newline, interval) for speed (size)
+- Durability is explicit instead of accidental
+
+IMPORTANT APIs:
+open()       -> Open output file
+write()      -> Flush buffer
+writev()     -> Flush buffer + large record together
+fdatasync()  -> Durability hook
+close()      -> Close file
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Writes a few log lines with FLUSH_ON_NEWLINE into
+        a scratch file (buffered_write.out)
+STEP 2: Writes one record with FLUSH_ON_INTERVAL, goes idle in
+        poll() with bw_timeout_ms(), and lets bw_tick() flush
+STEP 3: For record sizes 32 B .. 4 KB:
+        a) writes N records with one raw write() each
+        b) writes N records through the buffered writer
+STEP 4: Prints syscalls/sec, syscall count and MB/s for both
+STEP 5: Removes the scratch file
+
+COMPILE:
+gcc -O2 buffered_write.c
+./a.out [mb_per_size]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Log demo: number of write system calls used
+2. Interval demo: idle data flushed after ~the interval
+2. Table: record size, raw vs buffered syscalls, MB/s, speedup
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>      // For printf(), perror()
+#include <stdlib.h>     // For posix_memalign(), free(), atol()
+#include <string.h>     // For memcpy(), memset(), strlen()
+#include <errno.h>      // For errno, EINTR
+#include <fcntl.h>      // For open()
+#include <poll.h>       // For poll()
+#include <time.h>       // For clock_gettime()
+#include <unistd.h>     // For write(), fdatasync(), close(), unlink()
+#include <sys/uio.h>    // For writev(), struct iovec
+
+#define OUT_FILE           "buffered_write.out"
+
+#define FLUSH_ON_SIZE      0x1
+#define FLUSH_ON_INTERVAL  0x2
+#define FLUSH_ON_NEWLINE   0x4
+
+#define BW_ALIGN           4096
+#define BW_DEFAULT_SIZE    (64 * 1024)
+
+/*
+Buffered writer object.
+*/
+struct buffered_writer
+{
+    int            fd;
+    char          *buf;
+    size_t         size;
+    size_t         used;
+    int            policy;
+    double         interval_ms;
+    double         last_flush_ms;
+    int          (*durability)(int fd);
+    unsigned long  syscalls;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+CREATE BUFFERED WRITER
+-----------------------------------------------------------------
+size is rounded up to a multiple of BW_ALIGN.
+*/
+static int bw_init(struct buffered_writer *bw, int fd, size_t size, int policy,
+                   double interval_ms)
+{
+    memset(bw, 0, sizeof(*bw));
+    size = (size + BW_ALIGN - 1) / BW_ALIGN * BW_ALIGN;
+
+    if (posix_memalign((void **)&bw->buf, BW_ALIGN, size) != 0)
+    {
+        return -1;
+    }
+
+    bw->fd = fd;
+    bw->size = size;
+    bw->policy = policy;
+    bw->interval_ms = interval_ms;
+    bw->last_flush_ms = now_ms();
+    bw->durability = fdatasync;
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+WRITE IOVEC ARRAY COMPLETELY
+-----------------------------------------------------------------
+Retries after partial writes and EINTR.
+*/
+static int bw_writev_all(struct buffered_writer *bw, struct iovec *iov, int count)
+{
+    while (count > 0)
+    {
+        ssize_t n = writev(bw->fd, iov, count);
+
+        bw->syscalls++;
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        while (count > 0 && (size_t)n >= iov->iov_len)
+        {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+FLUSH BUFFER TO THE KERNEL
+-----------------------------------------------------------------
+*/
+static int bw_flush(struct buffered_writer *bw)
+{
+    struct iovec iov = { bw->buf, bw->used };
+
+    if (bw->used > 0 && bw_writev_all(bw, &iov, 1) == -1)
+    {
+        return -1;
+    }
+    bw->used = 0;
+    bw->last_flush_ms = now_ms();
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+FLUSH + DURABILITY HOOK
+-----------------------------------------------------------------
+*/
+static int bw_sync(struct buffered_writer *bw)
+{
+    if (bw_flush(bw) == -1)
+    {
+        return -1;
+    }
+    return bw->durability != NULL ? bw->durability(bw->fd) : 0;
+}
+
+/*
+-----------------------------------------------------------------
+APPEND ONE RECORD
+-----------------------------------------------------------------
+Small records are copied into the buffer. A record that does
+not fit is written together with the buffer by one writev().
+*/
+static int bw_write(struct buffered_writer *bw, const void *data, size_t len)
+{
+    if (bw->used + len > bw->size)
+    {
+        struct iovec iov[2] =
+        {
+            { bw->buf, bw->used },
+            { (void *)data, len },
+        };
+
+        if (len >= bw->size)
+        {
+            /* Large record: coalesce with buffer, no copy */
+            if (bw_writev_all(bw, bw->used ? iov : iov + 1, bw->used ? 2 : 1) == -1)
+            {
+                return -1;
+            }
+            bw->used = 0;
+            bw->last_flush_ms = now_ms();
+            return 0;
+        }
+        if (bw_flush(bw) == -1)
+        {
+            return -1;
+        }
+    }
+
+    memcpy(bw->buf + bw->used, data, len);
+    bw->used += len;
+
+    if ((bw->policy & FLUSH_ON_SIZE) && bw->used == bw->size)
+    {
+        return bw_flush(bw);
+    }
+    if ((bw->policy & FLUSH_ON_NEWLINE) && len > 0 && ((const char *)data)[len - 1] == '\n')
+    {
+        return bw_flush(bw);
+    }
+    if ((bw->policy & FLUSH_ON_INTERVAL) && now_ms() - bw->last_flush_ms >= bw->interval_ms)
+    {
+        return bw_flush(bw);
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+INTERVAL CHECK WHILE IDLE
+-----------------------------------------------------------------
+bw_write() only checks the interval when a record arrives. An
+idle writer calls bw_tick() from its event loop; bw_timeout_ms()
+says how long that loop may sleep.
+*/
+static int bw_tick(struct buffered_writer *bw)
+{
+    if ((bw->policy & FLUSH_ON_INTERVAL) && bw->used > 0 &&
+        now_ms() - bw->last_flush_ms >= bw->interval_ms)
+    {
+        return bw_flush(bw);
+    }
+    return 0;
+}
+
+static int bw_timeout_ms(const struct buffered_writer *bw)
+{
+    if (!(bw->policy & FLUSH_ON_INTERVAL) || bw->used == 0)
+    {
+        return -1;
+    }
+
+    double left = bw->last_flush_ms + bw->interval_ms - now_ms();
+    return left > 0 ? (int)left + 1 : 0;
+}
+
+/*
+-----------------------------------------------------------------
+FLUSH, CLOSE, FREE
+-----------------------------------------------------------------
+*/
+static int bw_close(struct buffered_writer *bw)
+{
+    int rc = bw_flush(bw);
+
+    if (close(bw->fd) == -1)
+    {
+        rc = -1;
+    }
+    free(bw->buf);
+    bw->buf = NULL;
+
+    return rc;
+}
+
+/*
+-----------------------------------------------------------------
+RAW write() OF ONE RECORD (BASELINE)
+-----------------------------------------------------------------
+*/
+static int raw_write(int fd, const char *data, size_t len, unsigned long *syscalls)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, data, len);
+
+        (*syscalls)++;
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+FAIL: REPORT, REMOVE SCRATCH FILE
+-----------------------------------------------------------------
+*/
+static int fail(const char *what)
+{
+    perror(what);
+    unlink(OUT_FILE);
+    return 1;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares raw write() with a buffered writer.
+*/
+int main(int argc, char *argv[])
+{
+    static const size_t record_sizes[] = { 32, 64, 128, 256, 512, 1024, 4096 };
+    long mb = argc > 1 ? atol(argv[1]) : 16;
+    size_t total = (size_t)(mb > 0 ? mb : 16) * 1024 * 1024;
+    struct buffered_writer bw;
+    char record[4096];
+
+    /*
+    STEP 1: Log lines with FLUSH_ON_NEWLINE
+    ---------------------------------------
+    Records without '\n' stay in the buffer until a newline.
+    */
+    int fd = open(OUT_FILE, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        return fail("open failed");
+    }
+    if (bw_init(&bw, fd, BW_DEFAULT_SIZE, FLUSH_ON_SIZE | FLUSH_ON_NEWLINE, 0) == -1)
+    {
+        return fail("bw_init failed");
+    }
+
+    const char *parts[] = { "Hello ", "from ", "buffered ", "writer\n", "second ", "line\n" };
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++)
+    {
+        bw_write(&bw, parts[i], strlen(parts[i]));
+    }
+    if (bw_sync(&bw) == -1)
+    {
+        return fail("bw_sync failed");
+    }
+    printf("Log demo: 6 records, 2 lines -> %lu write system calls\n", bw.syscalls);
+    bw_close(&bw);
+
+    /*
+    STEP 2: FLUSH_ON_INTERVAL with an idle writer
+    ---------------------------------------------
+    No further record arrives, so only bw_tick() can flush.
+    */
+    fd = open(OUT_FILE, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1 || bw_init(&bw, fd, BW_DEFAULT_SIZE, FLUSH_ON_INTERVAL, 50.0) == -1)
+    {
+        return fail("open failed");
+    }
+    double idle_start = now_ms();
+    if (bw_write(&bw, "idle record\n", 12) == -1)
+    {
+        return fail("bw_write failed");
+    }
+    while (bw.used > 0)
+    {
+        poll(NULL, 0, bw_timeout_ms(&bw));
+        if (bw_tick(&bw) == -1)
+        {
+            return fail("bw_tick failed");
+        }
+    }
+    printf("Interval demo: idle record flushed by bw_tick() after %.1f ms "
+           "(interval 50 ms), %lu write system call\n\n", now_ms() - idle_start, bw.syscalls);
+    bw_close(&bw);
+
+    /*
+    STEP 3 + 4: Raw vs buffered for each record size
+    ------------------------------------------------
+    */
+    memset(record, 'a', sizeof(record));
+    printf("%d MB per record size, buffer %d KB, FLUSH_ON_SIZE\n", (int)(total >> 20),
+           BW_DEFAULT_SIZE / 1024);
+    printf("%8s | %10s %12s %9s | %10s %12s %9s | %8s\n", "record", "raw calls",
+           "calls/s", "MB/s", "buf calls", "calls/s", "MB/s", "speedup");
+
+    for (size_t s = 0; s < sizeof(record_sizes) / sizeof(record_sizes[0]); s++)
+    {
+        size_t len = record_sizes[s];
+        size_t count = total / len;
+        unsigned long raw_calls = 0;
+
+        record[len - 1] = '\n';
+
+        /* a) raw write() per record */
+        fd = open(OUT_FILE, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+        if (fd == -1)
+        {
+            return fail("open failed");
+        }
+        double start = now_ms();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (raw_write(fd, record, len, &raw_calls) == -1)
+            {
+                return fail("write failed");
+            }
+        }
+        double raw_ms = now_ms() - start;
+        close(fd);
+
+        /* b) buffered writer */
+        fd = open(OUT_FILE, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+        if (fd == -1 || bw_init(&bw, fd, BW_DEFAULT_SIZE, FLUSH_ON_SIZE, 0) == -1)
+        {
+            return fail("open failed");
+        }
+        start = now_ms();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (bw_write(&bw, record, len) == -1)
+            {
+                return fail("bw_write failed");
+            }
+        }
+        bw_flush(&bw);
+        double buf_ms = now_ms() - start;
+        unsigned long buf_calls = bw.syscalls;
+        bw_close(&bw);
+
+        record[len - 1] = 'a';
+
+        double mbytes = count * len / 1048576.0;
+        printf("%7zuB | %10lu %12.0f %9.1f | %10lu %12.0f %9.1f | %7.1fx\n", len,
+               raw_calls, raw_calls / (raw_ms / 1e3), mbytes / (raw_ms / 1e3),
+               buf_calls, buf_calls / (buf_ms / 1e3), mbytes / (buf_ms / 1e3),
+               raw_ms / buf_ms);
+    }
+
+    /*
+    STEP 5: Remove the scratch file
+    -------------------------------
+    */
+    unlink(OUT_FILE);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Each write() is a system call: expensive for small records
+2. Buffer records in user space, flush in big chunks
+3. Flush policies: size (throughput), newline / interval (latency)
+4. writev() writes buffer + large record in one call
+5. bw_flush() -> kernel page cache
+6. bw_sync() -> flush + fdatasync() -> stable storage
+7. Always flush before close(), or data is lost
+8. Interval flush needs bw_tick() while the writer is idle
+
+DEFINITION (IN SIMPLE WORDS):
+Instead of handing every small piece of text to the
+kernel, the program collects pieces in a bucket and
+hands over the whole bucket at once.
+
+REAL-TIME EXAMPLES:
+- stdio (fwrite / setvbuf)
+- Logging libraries
+- Database write-ahead log writers
+- Network protocol encoders
+
+=================================================================
+*/
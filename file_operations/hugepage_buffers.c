@@ -0,0 +1,524 @@
+/*
+=================================================================
+HUGE-PAGE I/O BUFFERS – MAP_HUGETLB / MADV_HUGEPAGE (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to allocate large buffers on 1 GiB / 2 MiB huge pages
+2. How to fall back to transparent huge pages (madvise)
+3. How to fall back to normal 4 KiB pages
+4. How the same buffer is used by read(), write(), send()
+   and recv()
+5. How page faults and dTLB misses are counted with
+   perf_event_open()
+
+DEFINITION:
+The TLB (Translation Lookaside Buffer) caches virtual ->
+physical page translations. With 4 KiB pages a 256 MiB
+buffer needs 65536 translations; with 2 MiB pages only 128.
+Fewer translations mean fewer TLB misses, fewer page faults
+and less page-table walking for both the CPU and the kernel
+when it copies data in read() / recv().
+
+SYNTAX (MAJOR CALLS USED):
+void *mmap(void *addr, size_t len, int prot, int flags,
+           int fd, off_t off);
+int   madvise(void *addr, size_t len, int advice);
+int   perf_event_open(struct perf_event_attr *attr, pid_t pid,
+                      int cpu, int group_fd, unsigned long flags);
+
+SYNTAX EXPLANATION:
+MAP_HUGETLB | MAP_HUGE_2MB -> Pages from the hugetlb pool
+MAP_HUGETLB | MAP_HUGE_1GB -> 1 GiB pages (pool must exist)
+MADV_HUGEPAGE     -> Ask khugepaged / fault path for THP
+MADV_NOHUGEPAGE   -> Force normal pages (baseline)
+PERF_TYPE_HW_CACHE + DTLB + READ + MISS -> dTLB load misses
+PERF_COUNT_SW_PAGE_FAULTS  -> Page faults
+
+KEY POINTS:
+- hp_alloc() tries, in order: hugetlb 1G -> hugetlb 2M ->
+  THP (2 MiB aligned + MADV_HUGEPAGE) -> normal pages
+- hugetlb pages must be reserved by the admin:
+  echo 256 > /proc/sys/vm/nr_hugepages
+- THP backing is confirmed from /proc/self/smaps
+  (AnonHugePages of the mapping)
+- Hardware counters are often missing in VMs; the program
+  then prints "n/a" and still reports faults and throughput
+- Counters cover the calling thread only
+
+WHY HUGE-PAGE BUFFERS?
+- Multi-MB I/O buffers touch thousands of 4 KiB pages
+- Each first touch is a page fault
+- Random access over big buffers misses the TLB constantly
+
+IMPORTANT APIs:
+mmap()            -> Allocate buffer
+madvise()         -> Request / forbid THP
+read()/write()    -> File I/O through the buffer
+send()/recv()     -> Socket I/O through the buffer
+perf_event_open() -> Count faults and dTLB misses
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: For each allocation strategy (1G, 2M, THP, normal):
+        a) allocates the buffer (with fallback)
+        b) touches it once (page faults counted)
+        c) write() buffer to file, read() it back
+        d) send() / recv() through a socketpair
+        e) random 8-byte loads over the buffer
+STEP 2: Prints one row per strategy that really differs
+
+COMPILE:
+gcc -O2 -pthread hugepage_buffers.c
+./a.out [buffer_mb] [file]
+(default file: hugepage_buffers.tmp, removed at exit; a file
+named on the command line is kept)
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Strategy requested and what was obtained
+2. Faults on first touch, read / write / socket MB/s
+3. Random access ns per load and dTLB misses (or n/a)
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>               // For printf(), fopen()
+#include <stdlib.h>              // For atoi()
+#include <string.h>              // For memset(), strncmp()
+#include <stdint.h>              // For uintptr_t, uint64_t
+#include <fcntl.h>               // For open()
+#include <pthread.h>             // For sender thread
+#include <time.h>                // For clock_gettime()
+#include <unistd.h>              // For read(), write(), close()
+#include <sys/ioctl.h>           // For ioctl()
+#include <sys/mman.h>            // For mmap(), madvise()
+#include <sys/socket.h>          // For socketpair(), send(), recv()
+#include <sys/syscall.h>         // For SYS_perf_event_open
+#include <linux/mman.h>          // For MAP_HUGE_2MB, MAP_HUGE_1GB
+#include <linux/perf_event.h>    // For struct perf_event_attr
+
+#define HUGE_2M        (2UL * 1024 * 1024)
+#define HUGE_1G        (1024UL * 1024 * 1024)
+#define IO_CHUNK       (1024 * 1024)
+#define SOCK_CHUNK     (256 * 1024)
+#define RANDOM_LOADS   (16 * 1024 * 1024)
+
+/* Strategies, strongest first */
+enum hp_kind { HP_HUGETLB_1G, HP_HUGETLB_2M, HP_THP, HP_NORMAL };
+
+static const char *kind_names[] = { "hugetlb-1G", "hugetlb-2M", "thp", "normal" };
+
+/*
+A buffer and how it is backed.
+*/
+struct hp_buffer
+{
+    char        *addr;
+    size_t       size;     /* usable size */
+    void        *map;      /* what to munmap */
+    size_t       map_size;
+    enum hp_kind kind;
+};
+
+/*
+Data passed to the sender thread.
+*/
+struct send_job
+{
+    int    fd;
+    char  *buf;
+    size_t size;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN SECONDS
+-----------------------------------------------------------------
+*/
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+-----------------------------------------------------------------
+ALLOCATE BUFFER WITH HUGE-PAGE FALLBACK CHAIN
+-----------------------------------------------------------------
+Starts at 'prefer' and moves down until one works.
+*/
+static int hp_alloc(struct hp_buffer *b, size_t size, enum hp_kind prefer)
+{
+    memset(b, 0, sizeof(*b));
+    b->size = size;
+
+    for (enum hp_kind k = prefer; k <= HP_NORMAL; k++)
+    {
+        if (k == HP_HUGETLB_1G || k == HP_HUGETLB_2M)
+        {
+            size_t page = k == HP_HUGETLB_1G ? HUGE_1G : HUGE_2M;
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                        (k == HP_HUGETLB_1G ? MAP_HUGE_1GB : MAP_HUGE_2MB);
+            size_t len = (size + page - 1) / page * page;
+
+            void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (p == MAP_FAILED)
+            {
+                continue;   /* pool empty or size not supported */
+            }
+            b->map = b->addr = p;
+            b->map_size = len;
+            b->kind = k;
+            return 0;
+        }
+
+        /* THP / normal: over-allocate to get 2 MiB alignment */
+        size_t len = size + HUGE_2M;
+        char *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            return -1;
+        }
+        b->map = p;
+        b->map_size = len;
+        b->addr = (char *)(((uintptr_t)p + HUGE_2M - 1) & ~(HUGE_2M - 1));
+        b->kind = k;
+
+        if (k == HP_THP && madvise(b->addr, size, MADV_HUGEPAGE) == 0)
+        {
+            return 0;
+        }
+        madvise(b->addr, size, MADV_NOHUGEPAGE);
+        b->kind = HP_NORMAL;
+        return 0;
+    }
+
+    return -1;
+}
+
+static void hp_free(struct hp_buffer *b)
+{
+    if (b->map != NULL)
+    {
+        munmap(b->map, b->map_size);
+    }
+    memset(b, 0, sizeof(*b));
+}
+
+/*
+-----------------------------------------------------------------
+HOW MUCH OF A MAPPING IS REALLY ON THP (FROM SMAPS)
+-----------------------------------------------------------------
+Returns AnonHugePages in kB for the mapping holding addr.
+*/
+static long thp_backed_kb(const void *addr)
+{
+    FILE *f = fopen("/proc/self/smaps", "r");
+    char line[512];
+    int inside = 0;
+    long kb = 0;
+
+    if (f == NULL)
+    {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        unsigned long start, end;
+
+        /* Mapping header lines start with "start-end" */
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+        {
+            inside = (uintptr_t)addr >= start && (uintptr_t)addr < end;
+        }
+        else if (inside && strncmp(line, "AnonHugePages:", 14) == 0)
+        {
+            kb += atol(line + 14);
+        }
+    }
+    fclose(f);
+    return kb;
+}
+
+/*
+-----------------------------------------------------------------
+PERF COUNTERS (CALLING THREAD)
+-----------------------------------------------------------------
+Returns fd or -1 when the event is not available.
+*/
+static int open_counter(unsigned int type, unsigned long long config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd == -1)
+    {
+        /* Unprivileged users may only count user space */
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    return fd;
+}
+
+static void counter_start(int fd)
+{
+    if (fd != -1)
+    {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static long long counter_stop(int fd)
+{
+    long long value;
+
+    if (fd == -1)
+    {
+        return -1;
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &value, sizeof(value)) != sizeof(value))
+    {
+        return -1;
+    }
+    return value;
+}
+
+/*
+-----------------------------------------------------------------
+SOCKET SENDER THREAD
+-----------------------------------------------------------------
+*/
+static void *sender_main(void *arg)
+{
+    struct send_job *job = arg;
+
+    for (size_t off = 0; off < job->size; )
+    {
+        size_t len = job->size - off < SOCK_CHUNK ? job->size - off : SOCK_CHUNK;
+        ssize_t n = send(job->fd, job->buf + off, len, 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        off += n;
+    }
+    shutdown(job->fd, SHUT_WR);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+FORMAT A COUNTER VALUE
+-----------------------------------------------------------------
+*/
+static const char *fmt_count(char *out, size_t len, long long v)
+{
+    if (v < 0)
+    {
+        snprintf(out, len, "n/a");
+    }
+    else
+    {
+        snprintf(out, len, "%lld", v);
+    }
+    return out;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares huge-page and normal I/O buffers.
+*/
+int main(int argc, char *argv[])
+{
+    size_t size = (size_t)(argc > 1 ? atoi(argv[1]) : 256) * 1024 * 1024;
+    const char *path = argc > 2 ? argv[2] : "hugepage_buffers.tmp";
+    int scratch = argc <= 2;        /* only our own file is removed */
+    int seen[HP_NORMAL + 1] = { 0 };
+    char c1[32], c2[32];
+
+    if (size == 0)
+    {
+        fprintf(stderr, "usage: %s [buffer_mb] [file]\n", argv[0]);
+        return 1;
+    }
+
+    int faults_fd = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+    int dtlb_fd = open_counter(PERF_TYPE_HW_CACHE,
+                               PERF_COUNT_HW_CACHE_DTLB |
+                               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+    printf("Buffer %zu MB, dTLB counter %s, page-fault counter %s\n\n", size >> 20,
+           dtlb_fd == -1 ? "unavailable" : "ok", faults_fd == -1 ? "unavailable" : "ok");
+    printf("%-11s %-11s %7s %7s %10s %10s %10s %8s %12s\n", "requested", "obtained", "thp MB",
+           "faults", "write MB/s", "read MB/s", "sock MB/s", "rand ns", "dTLB misses");
+
+    /*
+    STEP 1: One run per allocation strategy
+    ---------------------------------------
+    */
+    for (enum hp_kind want = HP_HUGETLB_1G; want <= HP_NORMAL; want++)
+    {
+        struct hp_buffer b;
+        double t0, write_mbs, read_mbs, sock_mbs, rand_ns;
+
+        /* a) allocate */
+        if (hp_alloc(&b, size, want) == -1)
+        {
+            perror("mmap failed");
+            return 1;
+        }
+        if (seen[b.kind])
+        {
+            hp_free(&b);   /* fell back to a strategy already measured */
+            continue;
+        }
+        seen[b.kind] = 1;
+
+        /* b) first touch */
+        counter_start(faults_fd);
+        memset(b.addr, 'a', size);
+        long long faults = counter_stop(faults_fd);
+        long thp_kb = thp_backed_kb(b.addr);
+
+        /* c) write() then read() through the buffer */
+        int fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd == -1)
+        {
+            perror("open failed");
+            return 1;
+        }
+        t0 = now_sec();
+        for (size_t off = 0; off < size; off += IO_CHUNK)
+        {
+            if (write(fd, b.addr + off, size - off < IO_CHUNK ? size - off : IO_CHUNK) <= 0)
+            {
+                perror("write failed");
+                if (scratch)
+                {
+                    unlink(path);
+                }
+                return 1;
+            }
+        }
+        write_mbs = size / 1048576.0 / (now_sec() - t0);
+
+        lseek(fd, 0, SEEK_SET);
+        t0 = now_sec();
+        for (size_t off = 0; off < size; )
+        {
+            ssize_t n = read(fd, b.addr + off, size - off);
+            if (n <= 0)
+            {
+                break;
+            }
+            off += n;
+        }
+        read_mbs = size / 1048576.0 / (now_sec() - t0);
+        close(fd);
+
+        /* d) send() first half, recv() into second half */
+        int sv[2];
+        pthread_t sender;
+        struct send_job job;
+
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+        {
+            perror("socketpair failed");
+            return 1;
+        }
+        job.fd = sv[0];
+        job.buf = b.addr;
+        job.size = size / 2;
+
+        t0 = now_sec();
+        pthread_create(&sender, NULL, sender_main, &job);
+        size_t got = 0;
+        for (;;)
+        {
+            ssize_t n = recv(sv[1], b.addr + size / 2 + got, size / 2 - got < SOCK_CHUNK ?
+                             size / 2 - got : SOCK_CHUNK, 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            got += n;
+        }
+        pthread_join(sender, NULL);
+        sock_mbs = got / 1048576.0 / (now_sec() - t0);
+        close(sv[0]);
+        close(sv[1]);
+
+        /* e) random 8-byte loads (TLB bound) */
+        uint64_t x = 88172645463325252ull, sum = 0;
+        size_t slots = size / 64;
+
+        counter_start(dtlb_fd);
+        t0 = now_sec();
+        for (long i = 0; i < RANDOM_LOADS; i++)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            sum += *(volatile uint64_t *)(b.addr + (x % slots) * 64);
+        }
+        rand_ns = (now_sec() - t0) * 1e9 / RANDOM_LOADS;
+        long long dtlb = counter_stop(dtlb_fd);
+
+        printf("%-11s %-11s %7ld %7s %10.0f %10.0f %10.0f %8.2f %12s\n", kind_names[want],
+               kind_names[b.kind], thp_kb < 0 ? -1 : thp_kb / 1024,
+               fmt_count(c1, sizeof(c1), faults), write_mbs, read_mbs, sock_mbs, rand_ns,
+               fmt_count(c2, sizeof(c2), dtlb));
+
+        __asm__ volatile("" :: "r"(sum));     /* keeps the loads alive */
+        hp_free(&b);
+    }
+
+    if (scratch)
+    {
+        unlink(path);
+    }
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. 4 KiB pages: many TLB entries + many page faults
+2. MAP_HUGETLB uses the reserved hugetlb pool (nr_hugepages)
+3. MADV_HUGEPAGE asks for THP on a 2 MiB-aligned range
+4. Always keep a normal-page fallback
+5. Check /proc/self/smaps AnonHugePages to see real backing
+6. perf_event_open(): PAGE_FAULTS (software), dTLB (hardware)
+7. Hardware counters may be missing (VMs) -> handle -1
+
+DEFINITION (IN SIMPLE WORDS):
+Give the CPU a few giant pages instead of thousands of
+small ones, so it has far fewer addresses to look up.
+
+REAL-TIME EXAMPLES:
+- Databases (PostgreSQL huge_pages, Oracle SGA)
+- DPDK and high-speed packet buffers
+- JVM -XX:+UseLargePages
+- In-memory caches and ML inference buffers
+
+=================================================================
+*/
@@ -0,0 +1,602 @@
+/*
+=================================================================
+PARALLEL CHUNKED CRC32C – FILE CHECKSUM WITH pread() (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to split a file into fixed-size chunks
+2. How several threads read chunks in parallel with pread()
+3. How to compute CRC32C with the SSE4.2 crc32 instruction
+4. How partial CRCs are COMBINED into the whole-file CRC
+5. How to verify a file right after writing it (write + verify)
+
+DEFINITION:
+CRC32C (Castagnoli) is a 32-bit checksum used by iSCSI, ext4,
+Btrfs and many storage systems. Modern x86 CPUs compute it in
+hardware (SSE4.2, 8 bytes per instruction).
+
+A CRC is linear, so CRC(A || B) can be computed from CRC(A),
+CRC(B) and length(B) alone. This lets each thread checksum its
+own chunk and the results be merged in order at the end.
+
+SYNTAX (MAJOR CALLS USED):
+ssize_t pread(int fd, void *buf, size_t count, off_t offset);
+unsigned long long _mm_crc32_u64(unsigned long long crc,
+                                 unsigned long long v);
+int posix_fadvise(int fd, off_t offset, off_t len, int advice);
+
+SYNTAX EXPLANATION:
+pread()           -> Read at an offset; no shared file position,
+                     so threads never race on lseek()
+_mm_crc32_u64()   -> Hardware CRC32C step over 8 bytes
+crc32c_combine()  -> CRC(A||B) from CRC(A), CRC(B), len(B)
+                     using GF(2) matrix squaring (log2 steps)
+POSIX_FADV_DONTNEED -> Drop clean pages so verify reads disk
+
+KEY POINTS:
+- Chunk size default 4 MB; threads take chunks from an atomic
+  counter (dynamic load balance)
+- Per-chunk CRCs are stored, then combined in order; the
+  "shift by one chunk" matrix is built once per run
+- Software table fallback when SSE4.2 is missing
+- Every thread count must give the SAME CRC
+- Verify-after-write: CRC computed while writing, file synced,
+  page cache dropped, then re-read in parallel and compared
+
+WHY PARALLEL CHECKSUMS?
+- One core does a few GB/s of CRC32C but NVMe/RAID/page cache
+  can deliver more
+- Several in-flight pread() calls keep storage queues busy
+- Large backups and downloads must be verified quickly
+
+IMPORTANT APIs:
+open()            -> Open file
+pread()/pwrite()  -> Positional I/O, thread safe
+fdatasync()       -> Make written data durable
+posix_fadvise()   -> Drop cached pages before verifying
+pthread_create()  -> Worker threads
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Parses options (-w MB writes the file first)
+STEP 2: Verify-after-write: writes data, computes the CRC on
+        the fly, fdatasync(), drops the cache
+STEP 3: Compares hardware and software CRC speed (1 thread)
+STEP 4: Runs the parallel checksum for 1, 2, 4 ... threads
+STEP 5: Prints GB/s per thread count and OK / MISMATCH
+
+COMPILE:
+gcc -O2 -pthread parallel_checksum.c
+./a.out [-w size_mb] [-t max_threads] [-c chunk_kb] [file]
+(file defaults to x.txt; with -w and no file, a scratch file
+parallel_checksum.tmp is written and removed)
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Write CRC (when -w is used)
+2. Hardware vs software CRC32C GB/s
+3. Table: threads, ms, GB/s, CRC, OK / MISMATCH
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), perror()
+#include <stdlib.h>       // For malloc(), atoi()
+#include <string.h>       // For memset()
+#include <stdint.h>       // For uint32_t, uint64_t
+#include <fcntl.h>        // For open(), posix_fadvise()
+#include <pthread.h>      // For pthreads
+#include <stdatomic.h>    // For atomic_long
+#include <time.h>         // For clock_gettime()
+#include <unistd.h>       // For pread(), write(), fdatasync(), unlink()
+#include <sys/stat.h>     // For fstat()
+#include <nmmintrin.h>    // For _mm_crc32_u64() (SSE4.2)
+
+#define CRC32C_POLY   0x82F63B78u   /* reflected Castagnoli */
+#define WRITE_BLOCK   (1024 * 1024)
+#define MAX_THREADS   256
+
+typedef uint32_t (*crc_fn)(uint32_t crc, const void *buf, size_t len);
+
+/*
+Shared job description for all checksum threads.
+*/
+struct checksum_job
+{
+    int         fd;
+    off_t       size;
+    size_t      chunk_size;
+    long        chunk_count;
+    atomic_long next_chunk;
+    uint32_t   *chunk_crc;
+    crc_fn      crc;
+};
+
+static uint32_t crc_table[256];
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+SOFTWARE CRC32C (TABLE, 1 BYTE PER STEP)
+-----------------------------------------------------------------
+Same convention as zlib crc32(): pass 0 to start, result is
+final (pre/post inversion done inside).
+*/
+static void crc_table_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+        {
+            c = c & 1 ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        }
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const void *buf, size_t len)
+{
+    const unsigned char *p = buf;
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc = crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/*
+-----------------------------------------------------------------
+HARDWARE CRC32C (SSE4.2, 8 BYTES PER STEP)
+-----------------------------------------------------------------
+*/
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len)
+{
+    const unsigned char *p = buf;
+    uint64_t c = ~crc;
+
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    uint32_t c32 = (uint32_t)c;
+    for (; len > 0; len--)
+    {
+        c32 = _mm_crc32_u8(c32, *p++);
+    }
+    return ~c32;
+}
+
+/*
+-----------------------------------------------------------------
+CRC COMBINE (GF(2) MATRIX METHOD, AS IN ZLIB)
+-----------------------------------------------------------------
+Applies len2 zero bytes to crc1 through repeated squaring of
+the "shift by one zero bit" operator, then XORs in crc2.
+*/
+static uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec)
+{
+    uint32_t sum = 0;
+
+    while (vec)
+    {
+        if (vec & 1)
+        {
+            sum ^= *mat;
+        }
+        vec >>= 1;
+        mat++;
+    }
+    return sum;
+}
+
+static void gf2_matrix_square(uint32_t *square, const uint32_t *mat)
+{
+    for (int n = 0; n < 32; n++)
+    {
+        square[n] = gf2_matrix_times(mat, mat[n]);
+    }
+}
+
+static uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2)
+{
+    uint32_t even[32], odd[32];
+
+    if (len2 == 0)
+    {
+        return crc1;
+    }
+
+    /* Operator for one zero bit */
+    odd[0] = CRC32C_POLY;
+    for (int n = 1; n < 32; n++)
+    {
+        odd[n] = 1u << (n - 1);
+    }
+    gf2_matrix_square(even, odd);   /* two zero bits */
+    gf2_matrix_square(odd, even);   /* four zero bits */
+
+    do
+    {
+        gf2_matrix_square(even, odd);
+        if (len2 & 1)
+        {
+            crc1 = gf2_matrix_times(even, crc1);
+        }
+        len2 >>= 1;
+        if (len2 == 0)
+        {
+            break;
+        }
+        gf2_matrix_square(odd, even);
+        if (len2 & 1)
+        {
+            crc1 = gf2_matrix_times(odd, crc1);
+        }
+        len2 >>= 1;
+    } while (len2 != 0);
+
+    return crc1 ^ crc2;
+}
+
+/*
+-----------------------------------------------------------------
+CHECKSUM THREAD: TAKE CHUNK -> pread() -> CRC
+-----------------------------------------------------------------
+*/
+static void *checksum_worker(void *arg)
+{
+    struct checksum_job *job = arg;
+    char *buf = malloc(job->chunk_size);
+
+    if (buf == NULL)
+    {
+        return (void *)-1;
+    }
+
+    for (;;)
+    {
+        long idx = atomic_fetch_add(&job->next_chunk, 1);
+        if (idx >= job->chunk_count)
+        {
+            break;
+        }
+
+        off_t offset = (off_t)idx * job->chunk_size;
+        size_t want = job->size - offset < (off_t)job->chunk_size ?
+                      (size_t)(job->size - offset) : job->chunk_size;
+        size_t got = 0;
+
+        while (got < want)
+        {
+            ssize_t n = pread(job->fd, buf + got, want - got, offset + got);
+            if (n <= 0)
+            {
+                free(buf);
+                return (void *)-1;
+            }
+            got += n;
+        }
+        job->chunk_crc[idx] = job->crc(0, buf, want);
+    }
+
+    free(buf);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+PARALLEL CHECKSUM OF A WHOLE FILE
+-----------------------------------------------------------------
+Returns 0 and stores CRC in *out, or -1 on read error.
+*/
+static int parallel_crc(int fd, off_t size, size_t chunk_size, int threads,
+                        crc_fn fn, uint32_t *out)
+{
+    struct checksum_job job;
+    pthread_t tid[MAX_THREADS];
+    int failed = 0;
+
+    memset(&job, 0, sizeof(job));
+    job.fd = fd;
+    job.size = size;
+    job.chunk_size = chunk_size;
+    job.chunk_count = (long)((size + chunk_size - 1) / chunk_size);
+    job.crc = fn;
+    atomic_init(&job.next_chunk, 0);
+    job.chunk_crc = calloc(job.chunk_count + 1, sizeof(uint32_t));
+    if (job.chunk_crc == NULL)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_create(&tid[i], NULL, checksum_worker, &job);
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        void *ret;
+        pthread_join(tid[i], &ret);
+        failed |= ret != NULL;
+    }
+
+    /*
+    Combine chunk CRCs in file order. Shifting by chunk_size zero
+    bytes is linear, so its 32x32 matrix is built once (column n =
+    shift of bit n) and applied per chunk; only the tail chunk
+    needs the general combine.
+    */
+    uint32_t shift[32];
+    for (int n = 0; n < 32; n++)
+    {
+        shift[n] = crc32c_combine(1u << n, 0, chunk_size);
+    }
+
+    uint32_t crc = 0;
+    for (long i = 0; i < job.chunk_count; i++)
+    {
+        off_t offset = (off_t)i * chunk_size;
+
+        if (size - offset >= (off_t)chunk_size)
+        {
+            crc = gf2_matrix_times(shift, crc) ^ job.chunk_crc[i];
+        }
+        else
+        {
+            crc = crc32c_combine(crc, job.chunk_crc[i], size - offset);
+        }
+    }
+
+    free(job.chunk_crc);
+    *out = crc;
+    return failed ? -1 : 0;
+}
+
+/*
+-----------------------------------------------------------------
+WRITE FILE AND CRC IT WHILE WRITING
+-----------------------------------------------------------------
+*/
+static int write_with_crc(const char *path, size_t size_mb, crc_fn fn, uint32_t *out)
+{
+    char *block = malloc(WRITE_BLOCK);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    uint32_t crc = 0;
+
+    int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1 || block == NULL)
+    {
+        free(block);
+        return -1;
+    }
+
+    for (size_t b = 0; b < size_mb; b++)
+    {
+        /* xorshift pseudo-random content */
+        for (size_t i = 0; i < WRITE_BLOCK; i += 8)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            memcpy(block + i, &state, 8);
+        }
+        if (write(fd, block, WRITE_BLOCK) != WRITE_BLOCK)
+        {
+            close(fd);
+            free(block);
+            return -1;
+        }
+        crc = fn(crc, block, WRITE_BLOCK);
+    }
+
+    if (fdatasync(fd) == -1)
+    {
+        perror("fdatasync failed");
+    }
+    /* Drop clean pages so the verify really reads storage */
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    free(block);
+
+    *out = crc;
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program checksums a file in parallel chunks.
+*/
+int main(int argc, char *argv[])
+{
+    size_t write_mb = 0;
+    size_t chunk_size = 4 * 1024 * 1024;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cores > 4 ? cores : 4;
+    int opt;
+
+    /*
+    STEP 1: Options
+    ---------------
+    */
+    while ((opt = getopt(argc, argv, "w:t:c:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'w': write_mb = (size_t)atoi(optarg); break;
+        case 't': max_threads = atoi(optarg); break;
+        case 'c': chunk_size = (size_t)atoi(optarg) * 1024; break;
+        default:
+            fprintf(stderr, "usage: %s [-w size_mb] [-t max_threads] [-c chunk_kb] [file]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    /* -w without a file writes a private scratch file, not x.txt */
+    int scratch = write_mb > 0 && optind >= argc;
+    const char *path = optind < argc ? argv[optind] : scratch ? "parallel_checksum.tmp" : "x.txt";
+
+    if (max_threads < 1 || max_threads > MAX_THREADS || chunk_size == 0)
+    {
+        fprintf(stderr, "invalid thread count or chunk size\n");
+        return 1;
+    }
+
+    crc_table_init();
+    __builtin_cpu_init();
+    crc_fn fast = __builtin_cpu_supports("sse4.2") ? crc32c_hw : crc32c_sw;
+
+    /* Known-answer test: CRC32C("123456789") = 0xE3069283 */
+    if (fast(0, "123456789", 9) != 0xE3069283u ||
+        crc32c_combine(fast(0, "12345", 5), fast(0, "6789", 4), 4) != 0xE3069283u)
+    {
+        fprintf(stderr, "CRC32C self-test failed\n");
+        return 1;
+    }
+
+    /*
+    STEP 2: Verify-after-write mode
+    -------------------------------
+    */
+    uint32_t expected = 0;
+    int have_expected = 0;
+
+    if (write_mb > 0)
+    {
+        double t0 = now_ms();
+        if (write_with_crc(path, write_mb, fast, &expected) == -1)
+        {
+            perror("write failed");
+            if (scratch)
+            {
+                unlink(path);
+            }
+            return 1;
+        }
+        have_expected = 1;
+        printf("Wrote %zu MB to %s in %.1f ms, CRC32C while writing: %08x\n",
+               write_mb, path, now_ms() - t0, expected);
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (scratch)
+    {
+        unlink(path);       /* data lives on until fd is closed */
+    }
+    if (fd == -1)
+    {
+        perror("open failed");
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+    {
+        perror("fstat failed");
+        close(fd);
+        return 1;
+    }
+    printf("File %s: %.1f MB, chunk %zu KB, CRC32C %s\n\n", path,
+           st.st_size / 1048576.0, chunk_size / 1024,
+           fast == crc32c_hw ? "hardware (SSE4.2)" : "software");
+
+    /*
+    STEP 3: Verify first (cold), then hardware vs software speed
+    ------------------------------------------------------------
+    */
+    uint32_t crc;
+
+    if (have_expected)
+    {
+        double t0 = now_ms();
+        if (parallel_crc(fd, st.st_size, chunk_size, max_threads, fast, &crc) == -1)
+        {
+            perror("pread failed");
+            close(fd);
+            return 1;
+        }
+        double ms = now_ms() - t0;
+        printf("Verify (%d threads, cold cache): %08x %s  %.2f GB/s\n\n", max_threads, crc,
+               crc == expected ? "OK" : "MISMATCH", st.st_size / (ms / 1e3) / 1e9);
+        if (crc != expected)
+        {
+            close(fd);
+            return 1;
+        }
+    }
+
+    double t0 = now_ms();
+    parallel_crc(fd, st.st_size, chunk_size, 1, crc32c_sw, &expected);
+    double sw_ms = now_ms() - t0;
+    printf("software, 1 thread: %.2f GB/s\n", st.st_size / (sw_ms / 1e3) / 1e9);
+
+    /*
+    STEP 4 + 5: Scaling table (warm cache)
+    --------------------------------------
+    */
+    printf("\n%7s %9s %8s %10s\n", "threads", "ms", "GB/s", "crc32c");
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        t0 = now_ms();
+        if (parallel_crc(fd, st.st_size, chunk_size, threads, fast, &crc) == -1)
+        {
+            perror("pread failed");
+            close(fd);
+            return 1;
+        }
+        double ms = now_ms() - t0;
+
+        printf("%7d %9.1f %8.2f   %08x %s\n", threads, ms, st.st_size / (ms / 1e3) / 1e9,
+               crc, crc == expected ? "OK" : "MISMATCH");
+    }
+
+    close(fd);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. pread() = read at offset, safe to share one fd across threads
+2. SSE4.2 crc32 instruction = hardware CRC32C, 8 bytes/step
+3. CRC is linear: combine(crcA, crcB, lenB) = CRC(A || B)
+4. Chunks are combined in FILE ORDER, not completion order
+5. Self-test: CRC32C("123456789") = 0xE3069283
+6. Verify-after-write: fdatasync() + FADV_DONTNEED + re-read
+7. Same CRC for every thread count proves the combine step
+
+DEFINITION (IN SIMPLE WORDS):
+Cut the file into pieces, let several threads fingerprint
+the pieces at the same time, then glue the fingerprints
+together into one fingerprint for the whole file.
+
+REAL-TIME EXAMPLES:
+- Backup and restore verification
+- Download / object storage integrity checks (S3, GCS)
+- ext4 / Btrfs metadata checksums
+- iSCSI and NVMe-oF data digests
+
+=================================================================
+*/
@@ -0,0 +1,471 @@
+/*
+=================================================================
+PARALLEL LARGE-FILE WRITER – fallocate() + pwritev2() (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How fallocate() reserves the final file size up front
+2. How a file is split into offset ranges, one per thread
+3. How threads write their ranges with pwritev2() concurrently
+4. How ONE fdatasync() at the end makes everything durable
+5. How to count file extents with the FIEMAP ioctl
+6. How this compares with the serial O_TRUNC + write() path
+
+DEFINITION:
+fallocate() asks the filesystem to allocate blocks for a
+range of the file NOW, usually as few large contiguous
+extents. Later writes only fill in those blocks, so the file
+does not fragment and block allocation is not serialized
+through a single appending writer.
+
+pwritev2() writes a list of buffers at an explicit offset.
+Threads that use different offsets never share a file
+position, so no locking is needed between them.
+
+SYNTAX (MAJOR CALLS USED):
+int     fallocate(int fd, int mode, off_t offset, off_t len);
+ssize_t pwritev2(int fd, const struct iovec *iov, int iovcnt,
+                 off_t offset, int flags);
+int     fdatasync(int fd);
+int     ioctl(int fd, FS_IOC_FIEMAP, struct fiemap *fm);
+
+SYNTAX EXPLANATION:
+fallocate mode 0  -> Allocate blocks and extend the file size
+iov / iovcnt      -> Several buffers written in one syscall
+offset            -> Absolute position; file offset unchanged
+flags             -> RWF_* per-call flags (0 here)
+fm_extent_count=0 -> FIEMAP only COUNTS extents
+                     (result in fm_mapped_extents)
+
+KEY POINTS:
+- Range i = [i * size / T, (i + 1) * size / T), block aligned
+- Each thread issues 4 MB pwritev2() calls (4 x 1 MB iovecs)
+- Content depends only on the offset, so all runs produce
+  the same bytes; a sample of blocks is read back to verify
+- Serial path: O_TRUNC, write() in 1 MB blocks, fdatasync()
+- Some filesystems (tmpfs, overlay) do not support FIEMAP
+  or fallocate; the program reports n/a or falls back
+
+WHY PREALLOCATE + PARALLEL WRITE?
+- Fewer, larger extents -> faster later reads
+- ENOSPC is reported before any data is written
+- Several in-flight writes keep fast storage busy
+- One fdatasync() instead of syncing per chunk
+
+IMPORTANT APIs:
+open()            -> Create output file
+fallocate()       -> Preallocate blocks
+pwritev2()        -> Positional vectored write
+fdatasync()       -> Flush data to storage
+ioctl(FIEMAP)     -> Extent map of the file
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Serial baseline: O_TRUNC + write() + fdatasync()
+STEP 2: Counts the extents of the serial file
+STEP 3: For 1, 2, 4 ... threads: fallocate(), partitioned
+        pwritev2(), one fdatasync()
+STEP 4: Counts extents and verifies sample blocks
+STEP 5: Prints MB/s and extent count per run
+STEP 6: Removes the scratch file (default file only)
+
+COMPILE:
+gcc -O2 -pthread parallel_write.c
+./a.out [file] [size_mb] [max_threads]
+(default: scratch file parallel_write.tmp, removed at exit;
+a named file must not exist yet and is kept after the run)
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Table: mode, threads, ms, MB/s, extents, verify result
+2. Parallel rows usually show fewer extents than serial
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), perror()
+#include <stdlib.h>       // For malloc(), atoi()
+#include <string.h>       // For memset(), memcmp()
+#include <errno.h>        // For errno
+#include <fcntl.h>        // For open(), fallocate()
+#include <pthread.h>      // For pthreads
+#include <time.h>         // For clock_gettime()
+#include <unistd.h>       // For write(), fdatasync(), close(), access()
+#include <sys/ioctl.h>    // For ioctl()
+#include <sys/uio.h>      // For pwritev2(), struct iovec
+#include <linux/fs.h>     // For FS_IOC_FIEMAP
+#include <linux/fiemap.h> // For struct fiemap
+
+#define WRITE_BLOCK   (1024 * 1024)
+#define IOV_PER_CALL  4
+#define MAX_THREADS   256
+
+/*
+One thread's share of the file.
+*/
+struct write_range
+{
+    pthread_t thread;
+    int       fd;
+    off_t     start;
+    off_t     end;
+    int       error;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+FILL A BLOCK (CONTENT DEPENDS ONLY ON THE OFFSET)
+-----------------------------------------------------------------
+*/
+static void fill_block(char *buf, off_t offset)
+{
+    unsigned long long tag = (unsigned long long)offset / WRITE_BLOCK;
+
+    for (size_t i = 0; i < WRITE_BLOCK; i += sizeof(tag))
+    {
+        memcpy(buf + i, &tag, sizeof(tag));
+    }
+    buf[WRITE_BLOCK - 1] = '\n';
+}
+
+/*
+-----------------------------------------------------------------
+COUNT EXTENTS WITH FIEMAP
+-----------------------------------------------------------------
+Returns the extent count or -1 if unsupported.
+*/
+static long count_extents(int fd)
+{
+    struct fiemap fm;
+
+    memset(&fm, 0, sizeof(fm));
+    fm.fm_start = 0;
+    fm.fm_length = FIEMAP_MAX_OFFSET;
+    fm.fm_flags = FIEMAP_FLAG_SYNC;
+    fm.fm_extent_count = 0;   /* only count */
+
+    if (ioctl(fd, FS_IOC_FIEMAP, &fm) == -1)
+    {
+        return -1;
+    }
+    return fm.fm_mapped_extents;
+}
+
+/*
+-----------------------------------------------------------------
+VERIFY SAMPLE BLOCKS
+-----------------------------------------------------------------
+Checks first, last and every 16th block.
+*/
+static int verify_file(int fd, off_t size)
+{
+    char *expect = malloc(WRITE_BLOCK);
+    char *got = malloc(WRITE_BLOCK);
+    int ok = expect != NULL && got != NULL;
+    off_t blocks = size / WRITE_BLOCK;
+
+    for (off_t b = 0; ok && b < blocks; b++)
+    {
+        if (b % 16 != 0 && b != blocks - 1)
+        {
+            continue;
+        }
+        fill_block(expect, b * WRITE_BLOCK);
+        ok = pread(fd, got, WRITE_BLOCK, b * WRITE_BLOCK) == WRITE_BLOCK &&
+             memcmp(expect, got, WRITE_BLOCK) == 0;
+    }
+
+    free(expect);
+    free(got);
+    return ok;
+}
+
+/*
+-----------------------------------------------------------------
+SERIAL WRITER (LIKE write.c)
+-----------------------------------------------------------------
+*/
+static int serial_write(const char *path, off_t size)
+{
+    char *buf = malloc(WRITE_BLOCK);
+
+    int fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd == -1 || buf == NULL)
+    {
+        free(buf);
+        return -1;
+    }
+
+    for (off_t off = 0; off < size; off += WRITE_BLOCK)
+    {
+        fill_block(buf, off);
+        if (write(fd, buf, WRITE_BLOCK) != WRITE_BLOCK)
+        {
+            free(buf);
+            close(fd);
+            return -1;
+        }
+    }
+    free(buf);
+
+    if (fdatasync(fd) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+-----------------------------------------------------------------
+WORKER: WRITE ONE OFFSET RANGE WITH pwritev2()
+-----------------------------------------------------------------
+*/
+static void *range_writer(void *arg)
+{
+    struct write_range *r = arg;
+    struct iovec iov[IOV_PER_CALL];
+    char *bufs = malloc((size_t)WRITE_BLOCK * IOV_PER_CALL);
+
+    if (bufs == NULL)
+    {
+        r->error = ENOMEM;
+        return NULL;
+    }
+
+    for (off_t off = r->start; off < r->end; )
+    {
+        int cnt = 0;
+        size_t total = 0;
+
+        /* Up to IOV_PER_CALL blocks per syscall */
+        while (cnt < IOV_PER_CALL && off + (off_t)total < r->end)
+        {
+            iov[cnt].iov_base = bufs + (size_t)cnt * WRITE_BLOCK;
+            iov[cnt].iov_len = WRITE_BLOCK;
+            fill_block(iov[cnt].iov_base, off + total);
+            total += WRITE_BLOCK;
+            cnt++;
+        }
+
+        ssize_t n = pwritev2(r->fd, iov, cnt, off, 0);
+        if (n != (ssize_t)total)
+        {
+            /* Short vectored writes are rare on regular files */
+            r->error = n == -1 ? errno : EIO;
+            break;
+        }
+        off += total;
+    }
+
+    free(bufs);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+PARALLEL WRITER
+-----------------------------------------------------------------
+Returns open fd (for FIEMAP / verify) or -1.
+*/
+static int parallel_write(const char *path, off_t size, int threads, int *preallocated)
+{
+    struct write_range ranges[MAX_THREADS];
+    off_t blocks = size / WRITE_BLOCK;
+
+    int fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    /* Reserve the final size; fall back to sparse file */
+    *preallocated = fallocate(fd, 0, 0, size) == 0;
+    if (!*preallocated && ftruncate(fd, size) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        ranges[i].fd = fd;
+        ranges[i].start = blocks * i / threads * WRITE_BLOCK;
+        ranges[i].end = blocks * (i + 1) / threads * WRITE_BLOCK;
+        ranges[i].error = 0;
+        pthread_create(&ranges[i].thread, NULL, range_writer, &ranges[i]);
+    }
+
+    int error = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(ranges[i].thread, NULL);
+        if (ranges[i].error != 0)
+        {
+            error = ranges[i].error;
+        }
+    }
+
+    /* One sync for all ranges */
+    if (error == 0 && fdatasync(fd) == -1)
+    {
+        error = errno;
+    }
+    if (error != 0)
+    {
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+/*
+-----------------------------------------------------------------
+PRINT ONE RESULT ROW
+-----------------------------------------------------------------
+*/
+static void print_row(const char *mode, int threads, double ms, off_t size, int fd)
+{
+    long extents = count_extents(fd);
+    char ext[32];
+
+    if (extents < 0)
+    {
+        snprintf(ext, sizeof(ext), "n/a");
+    }
+    else
+    {
+        snprintf(ext, sizeof(ext), "%ld", extents);
+    }
+
+    printf("%-12s %7d %9.1f %9.1f %8s   %s\n", mode, threads, ms,
+           size / 1048576.0 / (ms / 1e3), ext, verify_file(fd, size) ? "OK" : "BAD");
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares serial and parallel file writing.
+*/
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 1 ? argv[1] : "parallel_write.tmp";
+    int scratch = argc <= 1;        /* only our own file is removed */
+    off_t size = (off_t)(argc > 2 ? atoi(argv[2]) : 512) * WRITE_BLOCK;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = argc > 3 ? atoi(argv[3]) : (cores > 4 ? cores : 4);
+    int preallocated = 0;
+    double t0;
+
+    if (size <= 0 || max_threads < 1 || max_threads > MAX_THREADS)
+    {
+        fprintf(stderr, "usage: %s [file] [size_mb] [max_threads]\n", argv[0]);
+        return 1;
+    }
+
+    if (!scratch && access(path, F_OK) == 0)
+    {
+        fprintf(stderr, "%s already exists; refusing to overwrite it\n", path);
+        return 1;
+    }
+
+    printf("File %s, %lld MB\n\n", path, (long long)(size / WRITE_BLOCK));
+    printf("%-12s %7s %9s %9s %8s   %s\n", "mode", "threads", "ms", "MB/s", "extents", "verify");
+
+    /*
+    STEP 1 + 2: Serial baseline
+    ---------------------------
+    */
+    if (scratch)
+    {
+        unlink(path);
+    }
+    t0 = now_ms();
+    int fd = serial_write(path, size);
+    if (fd == -1)
+    {
+        perror("serial write failed");
+        if (scratch)
+        {
+            unlink(path);
+        }
+        return 1;
+    }
+    print_row("serial", 1, now_ms() - t0, size, fd);
+    close(fd);
+
+    /*
+    STEP 3 + 4 + 5: Parallel writer
+    -------------------------------
+    */
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        /* O_TRUNC inside parallel_write() frees the old blocks */
+        t0 = now_ms();
+        fd = parallel_write(path, size, threads, &preallocated);
+        if (fd == -1)
+        {
+            perror("parallel write failed");
+            if (scratch)
+            {
+                unlink(path);
+            }
+            return 1;
+        }
+        print_row(preallocated ? "fallocate" : "sparse", threads, now_ms() - t0, size, fd);
+        close(fd);
+    }
+
+    /*
+    STEP 6: Remove the scratch file
+    -------------------------------
+    */
+    if (scratch)
+    {
+        unlink(path);
+    }
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. fallocate() reserves blocks first -> fewer extents
+2. Split the file into block-aligned offset ranges
+3. pwritev2() = positional + vectored, no shared file offset
+4. Threads never overlap, so no locks are needed
+5. One fdatasync() after all threads finish
+6. FIEMAP with fm_extent_count = 0 just counts extents
+7. Check fallocate() errors: not every filesystem supports it
+
+DEFINITION (IN SIMPLE WORDS):
+Book the whole parking area first, give each worker
+its own row of spaces, let them all park at the same
+time, then lock the gate once.
+
+REAL-TIME EXAMPLES:
+- Download managers (aria2, browsers)
+- Database data file and WAL preallocation
+- Video recording and VM disk image creation
+- Backup restore tools
+
+=================================================================
+*/
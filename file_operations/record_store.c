@@ -0,0 +1,695 @@
+/*
+=================================================================
+INDEXED RECORD STORE – DATA FILE + MMAPPED OFFSET INDEX (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to append fixed- or variable-length records to a file
+2. How a compact sidecar index stores each record's offset
+3. How the index is written in batches (header last)
+4. How readers mmap() the index and fetch record N with ONE
+   pread()
+5. How ranges are scanned zero-copy through mmap()
+6. How fast random reads are (records / second)
+
+DEFINITION:
+A record store keeps records back to back in a data file.
+To find record N without scanning, a second file (the index)
+holds a small fixed-size entry per record: its offset and
+length. Because every entry has the same size, entry N is at
+a known position, so lookup is O(1).
+
+FILE FORMAT:
+data file  : record 0 | record 1 | record 2 | ...
+index file : header { magic, version, record_size, count }
+             entry  { offset (8 bytes), length (4), check (4) }
+             ... one entry per record
+record_size != 0 -> fixed-length store: offset = N * size,
+                    no entries are needed
+
+SYNTAX (MAJOR CALLS USED):
+ssize_t write(int fd, const void *buf, size_t count);
+ssize_t pwrite(int fd, const void *buf, size_t count, off_t off);
+ssize_t pread(int fd, void *buf, size_t count, off_t offset);
+void   *mmap(void *addr, size_t len, int prot, int flags,
+             int fd, off_t off);
+
+SYNTAX EXPLANATION:
+Writer: data buffered in 1 MB, index entries in batches of
+        4096; order on flush = data, entries, header.count
+        -> a reader never sees an entry without its data
+Reader: mmap(index) -> entries[] array in memory
+        pread(data, len, entries[N].offset) -> record N
+        mmap(data) -> pointer to any record (zero-copy)
+
+KEY POINTS:
+- One syscall per random record read (pread)
+- Index stays small: 16 bytes per record
+- Header count is the commit point of a batch
+- Fixed-length records need no index entries at all
+- Each entry has a tiny checksum to catch corruption
+- Readers trust nothing: count is clamped to the index size
+  and every offset + length is checked against the data file
+- Scans use the mapped data directly (no copy into a buffer)
+
+WHY AN OFFSET INDEX?
+- Random access to record N without reading the file
+- Appends stay sequential (fast on any storage)
+- Readers can run while the writer appends
+
+IMPORTANT APIs:
+open()            -> Data and index files
+write()/pwrite()  -> Append data, write index batches
+pread()           -> Random record read
+mmap()            -> Map index and data for readers
+fdatasync()       -> Durable commit (optional, on close)
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Writes a variable-length store (64..1024 byte
+        records) of the requested size
+STEP 2: Opens a reader: mmap index, open data
+STEP 3: Random pread() benchmark (records / second)
+STEP 4: Random access through the data mmap
+STEP 5: Full range scan through mmap (MB / second)
+STEP 6: Same for a small fixed-length store (no entries)
+
+COMPILE:
+gcc -O2 record_store.c
+./a.out [size_mb] [random_reads] [base_name]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Records written, data and index size, write MB/s
+2. pread records/s, mmap records/s, scan MB/s
+3. All record checks OK
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), snprintf()
+#include <stdlib.h>       // For malloc(), atoi()
+#include <string.h>       // For memcpy(), memset()
+#include <stddef.h>       // For offsetof()
+#include <stdint.h>       // For uint64_t, uint32_t
+#include <errno.h>        // For errno, EINVAL
+#include <fcntl.h>        // For open()
+#include <time.h>         // For clock_gettime()
+#include <unistd.h>       // For write(), pread(), close()
+#include <sys/mman.h>     // For mmap()
+#include <sys/stat.h>     // For fstat()
+
+#define STORE_MAGIC    0x58444952u   /* "RIDX" */
+#define STORE_VERSION  1
+#define DATA_BUF       (1024 * 1024)
+#define INDEX_BATCH    4096
+#define MAX_RECORD     4096
+
+/*
+Index file header (first 24 bytes of the index).
+*/
+struct index_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t record_size;   /* 0 = variable length */
+    uint64_t count;         /* committed records */
+};
+
+/*
+One index entry per variable-length record.
+*/
+struct index_entry
+{
+    uint64_t offset;
+    uint32_t length;
+    uint32_t check;         /* FNV-1a of the first 8 bytes */
+};
+
+/*
+Writer state.
+*/
+struct record_writer
+{
+    int                 data_fd;
+    int                 index_fd;
+    uint64_t            record_size;
+    uint64_t            data_end;      /* incl. buffered bytes */
+    uint64_t            committed;     /* count in header */
+    char               *buf;
+    size_t              buf_len;
+    struct index_entry  batch[INDEX_BATCH];
+    int                 batched;
+};
+
+/*
+Reader state.
+*/
+struct record_reader
+{
+    int                  data_fd;
+    struct index_header *header;
+    struct index_entry  *entries;
+    size_t               index_len;
+    const char          *data;         /* mmap of data file */
+    size_t               data_len;
+    uint64_t             count;
+    uint64_t             record_size;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN SECONDS
+-----------------------------------------------------------------
+*/
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+-----------------------------------------------------------------
+SMALL CHECKSUM OF A RECORD PREFIX
+-----------------------------------------------------------------
+*/
+static uint32_t record_check(const char *rec, uint32_t len)
+{
+    uint32_t h = 2166136261u;
+
+    for (uint32_t i = 0; i < len && i < 8; i++)
+    {
+        h = (h ^ (unsigned char)rec[i]) * 16777619u;
+    }
+    return h;
+}
+
+/*
+-----------------------------------------------------------------
+WRITER: OPEN / FLUSH / APPEND / CLOSE
+-----------------------------------------------------------------
+*/
+static int rw_open(struct record_writer *w, const char *data_path,
+                   const char *index_path, uint64_t record_size)
+{
+    struct index_header h = { STORE_MAGIC, STORE_VERSION, record_size, 0 };
+
+    memset(w, 0, sizeof(*w));
+    w->record_size = record_size;
+    w->buf = malloc(DATA_BUF);
+    w->data_fd = open(data_path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    w->index_fd = open(index_path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+
+    if (w->buf == NULL || w->data_fd == -1 || w->index_fd == -1 ||
+        pwrite(w->index_fd, &h, sizeof(h), 0) != sizeof(h))
+    {
+        int saved = errno;
+        if (w->data_fd != -1)
+        {
+            close(w->data_fd);
+        }
+        if (w->index_fd != -1)
+        {
+            close(w->index_fd);
+        }
+        free(w->buf);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+/* Data first, then entries, then header count */
+static int rw_flush(struct record_writer *w)
+{
+    if (w->buf_len > 0)
+    {
+        if (write(w->data_fd, w->buf, w->buf_len) != (ssize_t)w->buf_len)
+        {
+            return -1;
+        }
+        w->buf_len = 0;
+    }
+
+    uint64_t pending = (uint64_t)w->batched;
+    if (pending == 0)
+    {
+        return 0;
+    }
+
+    if (w->record_size == 0)
+    {
+        size_t len = w->batched * sizeof(struct index_entry);
+        off_t off = sizeof(struct index_header) + w->committed * sizeof(struct index_entry);
+
+        if (pwrite(w->index_fd, w->batch, len, off) != (ssize_t)len)
+        {
+            return -1;
+        }
+    }
+
+    uint64_t count = w->committed + pending;
+    if (pwrite(w->index_fd, &count, sizeof(count),
+               offsetof(struct index_header, count)) != sizeof(count))
+    {
+        return -1;
+    }
+    w->committed = count;
+    w->batched = 0;
+    return 0;
+}
+
+static int rw_append(struct record_writer *w, const char *rec, uint32_t len)
+{
+    if (len > MAX_RECORD || (w->record_size != 0 && len != w->record_size))
+    {
+        return -1;
+    }
+    if (w->buf_len + len > DATA_BUF && rw_flush(w) == -1)
+    {
+        return -1;
+    }
+
+    memcpy(w->buf + w->buf_len, rec, len);
+    w->buf_len += len;
+
+    /* Fixed-length stores only count records */
+    w->batch[w->batched].offset = w->data_end;
+    w->batch[w->batched].length = len;
+    w->batch[w->batched].check = record_check(rec, len);
+    w->batched++;
+    w->data_end += len;
+
+    if (w->batched == INDEX_BATCH)
+    {
+        return rw_flush(w);
+    }
+    return 0;
+}
+
+static int rw_close(struct record_writer *w)
+{
+    int ret = rw_flush(w);
+
+    if (ret == 0 && (fdatasync(w->data_fd) == -1 || fdatasync(w->index_fd) == -1))
+    {
+        ret = -1;
+    }
+    close(w->data_fd);
+    close(w->index_fd);
+    free(w->buf);
+    return ret;
+}
+
+/*
+-----------------------------------------------------------------
+READER: OPEN (MMAP INDEX AND DATA) / CLOSE
+-----------------------------------------------------------------
+*/
+static void rr_close(struct record_reader *r)
+{
+    int saved = errno;
+
+    if (r->data != NULL && r->data != MAP_FAILED)
+    {
+        munmap((void *)r->data, r->data_len);
+    }
+    if (r->header != NULL && r->header != MAP_FAILED)
+    {
+        munmap(r->header, r->index_len);
+    }
+    if (r->data_fd != -1)
+    {
+        close(r->data_fd);
+    }
+    errno = saved;
+}
+
+static int rr_open(struct record_reader *r, const char *data_path, const char *index_path)
+{
+    struct stat st;
+
+    memset(r, 0, sizeof(*r));
+    int index_fd = open(index_path, O_RDONLY);
+    r->data_fd = open(data_path, O_RDONLY);
+    if (index_fd == -1 || r->data_fd == -1 || fstat(index_fd, &st) == -1)
+    {
+        if (index_fd != -1)
+        {
+            close(index_fd);
+        }
+        rr_close(r);
+        return -1;
+    }
+    if (st.st_size < (off_t)sizeof(struct index_header))
+    {
+        close(index_fd);
+        rr_close(r);
+        errno = EINVAL;
+        return -1;
+    }
+
+    r->index_len = st.st_size;
+    r->header = mmap(NULL, r->index_len, PROT_READ, MAP_SHARED, index_fd, 0);
+    close(index_fd);   /* the mapping stays valid */
+    if (r->header == MAP_FAILED)
+    {
+        rr_close(r);
+        return -1;
+    }
+    if (r->header->magic != STORE_MAGIC || r->header->version != STORE_VERSION ||
+        r->header->record_size > MAX_RECORD)
+    {
+        errno = EINVAL;
+        rr_close(r);
+        return -1;
+    }
+    r->entries = (struct index_entry *)(r->header + 1);
+    r->count = r->header->count;
+    r->record_size = r->header->record_size;
+
+    if (fstat(r->data_fd, &st) == -1)
+    {
+        rr_close(r);
+        return -1;
+    }
+    if (st.st_size == 0)
+    {
+        rr_close(r);
+        errno = EINVAL;
+        return -1;
+    }
+    r->data_len = st.st_size;
+    r->data = mmap(NULL, r->data_len, PROT_READ, MAP_SHARED, r->data_fd, 0);
+    if (r->data == MAP_FAILED)
+    {
+        rr_close(r);
+        return -1;
+    }
+
+    /* Never trust the header: clamp count to what the files hold */
+    uint64_t max = r->record_size != 0 ?
+                   r->data_len / r->record_size :
+                   (r->index_len - sizeof(struct index_header)) / sizeof(struct index_entry);
+    if (r->count > max)
+    {
+        r->count = max;
+    }
+    return 0;
+}
+
+/* Offset and length of record n; -1 if it lies outside the data file */
+static int rr_locate(const struct record_reader *r, uint64_t n, uint64_t *off, uint32_t *len)
+{
+    if (r->record_size != 0)
+    {
+        *off = n * r->record_size;
+        *len = (uint32_t)r->record_size;
+    }
+    else
+    {
+        *off = r->entries[n].offset;
+        *len = r->entries[n].length;
+    }
+    return *off <= r->data_len && *len <= r->data_len - *off ? 0 : -1;
+}
+
+/*
+-----------------------------------------------------------------
+READER: GET RECORD N WITH ONE pread()
+-----------------------------------------------------------------
+Returns record length or -1.
+*/
+static ssize_t rr_get(const struct record_reader *r, uint64_t n, char *buf, size_t cap)
+{
+    uint64_t off;
+    uint32_t len;
+
+    if (n >= r->count)
+    {
+        return -1;
+    }
+    if (rr_locate(r, n, &off, &len) == -1 || len > cap)
+    {
+        return -1;
+    }
+    return pread(r->data_fd, buf, len, off) == (ssize_t)len ? (ssize_t)len : -1;
+}
+
+/*
+-----------------------------------------------------------------
+READER: ZERO-COPY POINTER TO RECORD N (MMAP)
+-----------------------------------------------------------------
+*/
+static const char *rr_map(const struct record_reader *r, uint64_t n, uint32_t *len)
+{
+    uint64_t off;
+
+    if (n >= r->count)
+    {
+        return NULL;
+    }
+    return rr_locate(r, n, &off, len) == 0 ? r->data + off : NULL;
+}
+
+/*
+-----------------------------------------------------------------
+BUILD / VERIFY A TEST RECORD
+-----------------------------------------------------------------
+First 8 bytes = record number, rest = (n & 0xff).
+*/
+static void make_record(char *rec, uint64_t n, uint32_t len)
+{
+    memset(rec, (int)(n & 0xff), len);
+    memcpy(rec, &n, sizeof(n));
+}
+
+static int record_ok(const struct record_reader *r, const char *rec, uint64_t n, uint32_t len)
+{
+    uint64_t id;
+
+    if (len < sizeof(id))
+    {
+        return 0;
+    }
+    memcpy(&id, rec, sizeof(id));
+    return id == n && (unsigned char)rec[len - 1] == (n & 0xff) &&
+           (r->record_size != 0 || r->entries[n].check == record_check(rec, len));
+}
+
+/*
+-----------------------------------------------------------------
+RUN ALL READ BENCHMARKS ON ONE STORE
+-----------------------------------------------------------------
+*/
+static int bench_store(const char *data_path, const char *index_path, long reads)
+{
+    struct record_reader r;
+    char buf[MAX_RECORD];
+    uint64_t x = 88172645463325252ull;
+    long bad = 0;
+    double t0, t;
+
+    if (rr_open(&r, data_path, index_path) == -1)
+    {
+        perror("reader open failed");
+        return -1;
+    }
+    if (r.count == 0)
+    {
+        fprintf(stderr, "store is empty\n");
+        rr_close(&r);
+        return -1;
+    }
+
+    /* Random reads with pread() */
+    t0 = now_sec();
+    for (long i = 0; i < reads; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        uint64_t n = x % r.count;
+        ssize_t len = rr_get(&r, n, buf, sizeof(buf));
+        bad += len <= 0 || !record_ok(&r, buf, n, (uint32_t)len);
+    }
+    t = now_sec() - t0;
+    printf("  random pread : %10.0f records/s\n", reads / t);
+
+    /* Random reads through the data mapping */
+    t0 = now_sec();
+    for (long i = 0; i < reads; i++)
+    {
+        uint32_t len;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        uint64_t n = x % r.count;
+        const char *rec = rr_map(&r, n, &len);
+        bad += rec == NULL || !record_ok(&r, rec, n, len);
+    }
+    t = now_sec() - t0;
+    printf("  random mmap  : %10.0f records/s\n", reads / t);
+
+    /* Full range scan, zero-copy */
+    uint64_t sum = 0, bytes = 0;
+    t0 = now_sec();
+    for (uint64_t n = 0; n < r.count; n++)
+    {
+        uint32_t len;
+        const char *rec = rr_map(&r, n, &len);
+        if (rec == NULL)
+        {
+            bad++;
+            break;
+        }
+        for (uint32_t i = 0; i < len; i++)
+        {
+            sum += (unsigned char)rec[i];
+        }
+        bytes += len;
+    }
+    t = now_sec() - t0;
+    printf("  range scan   : %10.0f records/s, %.0f MB/s (sum %llu)\n", r.count / t,
+           bytes / 1048576.0 / t, (unsigned long long)sum);
+    printf("  checks       : %s\n", bad == 0 ? "all OK" : "FAILED");
+
+    rr_close(&r);
+    return bad == 0 ? 0 : -1;
+}
+
+/*
+-----------------------------------------------------------------
+WRITE A STORE OF ABOUT size BYTES
+-----------------------------------------------------------------
+record_size 0 = variable length 64..1024
+*/
+static int write_store(const char *data_path, const char *index_path,
+                       uint64_t size, uint64_t record_size)
+{
+    struct record_writer *w = malloc(sizeof(struct record_writer));
+    char rec[MAX_RECORD];
+    unsigned int seed = 7;
+    uint64_t n = 0;
+
+    if (w == NULL || rw_open(w, data_path, index_path, record_size) == -1)
+    {
+        free(w);
+        return -1;
+    }
+
+    double t0 = now_sec();
+    while (w->data_end < size)
+    {
+        uint32_t len = record_size ? (uint32_t)record_size : 64 + (uint32_t)rand_r(&seed) % 961;
+        make_record(rec, n++, len);
+        if (rw_append(w, rec, len) == -1)
+        {
+            rw_close(w);
+            free(w);
+            return -1;
+        }
+    }
+    uint64_t data_end = w->data_end;
+    if (rw_close(w) == -1)
+    {
+        free(w);
+        return -1;
+    }
+    double t = now_sec() - t0;
+
+    struct stat st;
+    stat(index_path, &st);
+    printf("  wrote %llu records, data %.1f MB, index %.1f MB, %.0f MB/s\n",
+           (unsigned long long)n, data_end / 1048576.0, st.st_size / 1048576.0,
+           data_end / 1048576.0 / t);
+    free(w);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program builds and benchmarks an indexed record store.
+*/
+int main(int argc, char *argv[])
+{
+    uint64_t size = (uint64_t)(argc > 1 ? atoi(argv[1]) : 2048) * 1024 * 1024;
+    long reads = argc > 2 ? atol(argv[2]) : 1000000;
+    const char *base = argc > 3 ? argv[3] : "records";
+    char data_path[4096], index_path[4096];
+
+    if (size == 0 || reads <= 0)
+    {
+        fprintf(stderr, "usage: %s [size_mb] [random_reads] [base_name]\n", argv[0]);
+        return 1;
+    }
+    snprintf(data_path, sizeof(data_path), "%s.dat", base);
+    snprintf(index_path, sizeof(index_path), "%s.idx", base);
+
+    /*
+    STEP 1 - 5: Variable-length store
+    ---------------------------------
+    */
+    printf("Variable-length records (64..1024 bytes):\n");
+    if (write_store(data_path, index_path, size, 0) == -1)
+    {
+        perror("write store failed");
+        return 1;
+    }
+    if (bench_store(data_path, index_path, reads) == -1)
+    {
+        return 1;
+    }
+
+    /*
+    STEP 6: Fixed-length store (index holds only the header)
+    --------------------------------------------------------
+    */
+    printf("\nFixed-length records (256 bytes):\n");
+    if (write_store(data_path, index_path, size / 4, 256) == -1)
+    {
+        perror("write store failed");
+        return 1;
+    }
+    if (bench_store(data_path, index_path, reads) == -1)
+    {
+        return 1;
+    }
+
+    unlink(data_path);
+    unlink(index_path);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Data file = records back to back, append only
+2. Index file = header + fixed-size entry per record
+3. Entry N is at header_size + N * entry_size -> O(1) lookup
+4. Flush order: data -> entries -> header count (commit)
+5. Reader: mmap(index), then ONE pread() per record
+6. mmap(data) gives zero-copy access for scans
+7. Fixed-length records: offset = N * size, no entries
+8. Reader clamps count to the index size and bounds-checks
+   every entry against the data file (no crash on bad files)
+
+DEFINITION (IN SIMPLE WORDS):
+Keep the records in one big file and a small table of
+contents that says where each record starts.
+
+REAL-TIME EXAMPLES:
+- Kafka segment + offset index files
+- Database heap files with row pointers
+- Search engine posting lists
+- Time-series and log stores
+
+=================================================================
+*/
@@ -0,0 +1,607 @@
+/*
+=================================================================
+SIMD BYTE SCANNING – LINE COUNT & RECORD OFFSETS (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to count newlines 16 / 32 / 64 bytes at a time
+2. How SSE2, AVX2 and AVX-512 kernels are chosen at runtime
+3. How a scalar fallback keeps the program portable
+4. How to build a record offset table from a delimiter
+5. How the kernels compare with memchr() and a byte loop (GB/s)
+
+DEFINITION:
+SIMD (Single Instruction, Multiple Data) compares many bytes
+with ONE instruction. The result of the compare is turned into
+a bit mask (one bit per byte). popcount(mask) counts the
+matching bytes; ctz(mask) gives the position of the next one.
+
+SYNTAX (MAJOR CALLS USED):
+__m128i _mm_cmpeq_epi8(__m128i a, __m128i b);      // SSE2
+int     _mm_movemask_epi8(__m128i a);
+__m256i _mm256_cmpeq_epi8(__m256i a, __m256i b);   // AVX2
+int     _mm256_movemask_epi8(__m256i a);
+__mmask64 _mm512_cmpeq_epi8_mask(__m512i a, __m512i b); // AVX-512BW
+int     __builtin_cpu_supports(const char *feature);
+
+SYNTAX EXPLANATION:
+cmpeq_epi8        -> 0xFF where byte == delimiter, else 0x00
+movemask          -> Packs the top bit of each byte into an int
+popcount(mask)    -> How many delimiters in this block
+ctz(mask)         -> Index of the lowest delimiter in the block
+mask & (mask - 1) -> Clears that lowest bit (next delimiter)
+
+__attribute__((target("avx2")))
+                  -> Compile ONE function for AVX2 while the
+                     rest of the program stays baseline x86-64
+
+KEY POINTS:
+- Kernels: scalar, sse2, avx2, avx512bw
+- Dispatch happens once (function pointers), not per call
+- Unaligned loads (loadu) work on any read()/mmap() buffer
+- Tail bytes (< vector width) use the scalar loop
+- Offset table: start offset of every record (line)
+- Same kernels work on a read() stream and an mmap() view
+
+WHY SIMD SCANNING?
+- A byte loop does ~1 byte per cycle
+- AVX2 / AVX-512 process 32 / 64 bytes per compare
+- Line counting and splitting are the hot loop of log,
+  CSV and text processing
+
+IMPORTANT APIs:
+read()            -> Stream file content into a buffer
+mmap()            -> Map whole file, scan in place
+memchr()          -> libc reference (also vectorized)
+__builtin_cpu_supports() -> Runtime CPU feature check
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Detects CPU features and selects the best kernel
+STEP 2: If the file exists: counts lines via read() and via
+        mmap() and prints the first record offsets
+STEP 3: Builds a synthetic buffer with random line lengths
+STEP 4: Benchmarks line count (naive, memchr, each kernel)
+STEP 5: Benchmarks offset-table building for each kernel
+
+COMPILE:
+gcc -O2 simd_scan.c
+./a.out [file] [buffer_mb]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Supported kernels and the selected one
+2. Line count of the file (read and mmap paths agree)
+3. GB/s table for counting and for offset tables
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), perror()
+#include <stdlib.h>       // For malloc(), free(), atoi()
+#include <string.h>       // For memchr()
+#include <fcntl.h>        // For open()
+#include <time.h>         // For clock_gettime()
+#include <unistd.h>       // For read(), close()
+#include <sys/mman.h>     // For mmap()
+#include <sys/stat.h>     // For fstat()
+#include <immintrin.h>    // For SSE2 / AVX2 / AVX-512 intrinsics
+
+#define READ_CHUNK   (1024 * 1024)
+#define BENCH_ROUNDS 5
+
+typedef size_t (*count_fn)(const char *buf, size_t len, char delim);
+typedef size_t (*index_fn)(const char *buf, size_t len, char delim,
+                           size_t base, size_t *offsets, size_t max);
+
+/*
+One scanning kernel: name, CPU feature and the two operations.
+*/
+struct kernel
+{
+    const char *name;
+    const char *feature;  /* NULL = always available */
+    count_fn    count;
+    index_fn    index;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN SECONDS
+-----------------------------------------------------------------
+*/
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+-----------------------------------------------------------------
+SCALAR KERNEL (FALLBACK + TAIL HANDLING)
+-----------------------------------------------------------------
+index: stores offset of the byte AFTER each delimiter
+       (= start of the next record), returns count stored.
+*/
+static size_t count_scalar(const char *buf, size_t len, char delim)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        n += buf[i] == delim;
+    }
+    return n;
+}
+
+static size_t index_scalar(const char *buf, size_t len, char delim,
+                           size_t base, size_t *offsets, size_t max)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < len && n < max; i++)
+    {
+        if (buf[i] == delim)
+        {
+            offsets[n++] = base + i + 1;
+        }
+    }
+    return n;
+}
+
+/*
+-----------------------------------------------------------------
+WALK BITS OF A MASK INTO THE OFFSET TABLE
+-----------------------------------------------------------------
+*/
+static inline size_t emit_mask(unsigned long long mask, size_t pos,
+                               size_t *offsets, size_t n, size_t max)
+{
+    while (mask != 0 && n < max)
+    {
+        offsets[n++] = pos + (size_t)__builtin_ctzll(mask) + 1;
+        mask &= mask - 1;
+    }
+    return n;
+}
+
+/*
+-----------------------------------------------------------------
+SSE2 KERNEL (16 BYTES PER COMPARE)
+-----------------------------------------------------------------
+*/
+static size_t count_sse2(const char *buf, size_t len, char delim)
+{
+    __m128i d = _mm_set1_epi8(delim);
+    size_t n = 0, i = 0;
+
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+        n += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)));
+    }
+    return n + count_scalar(buf + i, len - i, delim);
+}
+
+static size_t index_sse2(const char *buf, size_t len, char delim,
+                         size_t base, size_t *offsets, size_t max)
+{
+    __m128i d = _mm_set1_epi8(delim);
+    size_t n = 0, i = 0;
+
+    for (; i + 16 <= len && n < max; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, d));
+        n = emit_mask(mask, base + i, offsets, n, max);
+    }
+    return n + index_scalar(buf + i, len - i, delim, base + i, offsets + n, max - n);
+}
+
+/*
+-----------------------------------------------------------------
+AVX2 KERNEL (32 BYTES PER COMPARE)
+-----------------------------------------------------------------
+*/
+__attribute__((target("avx2,popcnt")))
+static size_t count_avx2(const char *buf, size_t len, char delim)
+{
+    __m256i d = _mm256_set1_epi8(delim);
+    size_t n = 0, i = 0;
+
+    /* Two vectors per iteration hides load latency */
+    for (; i + 64 <= len; i += 64)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(buf + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(buf + i + 32));
+        unsigned int ma = _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, d));
+        unsigned int mb = _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, d));
+        n += __builtin_popcountll(((unsigned long long)mb << 32) | ma);
+    }
+    return n + count_scalar(buf + i, len - i, delim);
+}
+
+__attribute__((target("avx2,bmi")))
+static size_t index_avx2(const char *buf, size_t len, char delim,
+                         size_t base, size_t *offsets, size_t max)
+{
+    __m256i d = _mm256_set1_epi8(delim);
+    size_t n = 0, i = 0;
+
+    for (; i + 32 <= len && n < max; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+        unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, d));
+        n = emit_mask(mask, base + i, offsets, n, max);
+    }
+    return n + index_scalar(buf + i, len - i, delim, base + i, offsets + n, max - n);
+}
+
+/*
+-----------------------------------------------------------------
+AVX-512BW KERNEL (64 BYTES PER COMPARE)
+-----------------------------------------------------------------
+*/
+__attribute__((target("avx512bw,popcnt")))
+static size_t count_avx512(const char *buf, size_t len, char delim)
+{
+    __m512i d = _mm512_set1_epi8(delim);
+    size_t n = 0, i = 0;
+
+    for (; i + 64 <= len; i += 64)
+    {
+        __m512i v = _mm512_loadu_si512((const void *)(buf + i));
+        n += __builtin_popcountll(_mm512_cmpeq_epi8_mask(v, d));
+    }
+    return n + count_scalar(buf + i, len - i, delim);
+}
+
+__attribute__((target("avx512bw,bmi")))
+static size_t index_avx512(const char *buf, size_t len, char delim,
+                           size_t base, size_t *offsets, size_t max)
+{
+    __m512i d = _mm512_set1_epi8(delim);
+    size_t n = 0, i = 0;
+
+    for (; i + 64 <= len && n < max; i += 64)
+    {
+        __m512i v = _mm512_loadu_si512((const void *)(buf + i));
+        n = emit_mask(_mm512_cmpeq_epi8_mask(v, d), base + i, offsets, n, max);
+    }
+    return n + index_scalar(buf + i, len - i, delim, base + i, offsets + n, max - n);
+}
+
+/* Ordered from slowest to fastest */
+static const struct kernel kernels[] =
+{
+    { "scalar", NULL,       count_scalar, index_scalar },
+    { "sse2",   "sse2",     count_sse2,   index_sse2 },
+    { "avx2",   "avx2",     count_avx2,   index_avx2 },
+    { "avx512", "avx512bw", count_avx512, index_avx512 },
+};
+#define KERNEL_COUNT (int)(sizeof(kernels) / sizeof(kernels[0]))
+
+/*
+-----------------------------------------------------------------
+RUNTIME CPU CHECK
+-----------------------------------------------------------------
+__builtin_cpu_supports() needs a literal, so map the names.
+*/
+static int kernel_supported(const struct kernel *k)
+{
+    __builtin_cpu_init();
+
+    if (k->feature == NULL)
+    {
+        return 1;
+    }
+    if (strcmp(k->feature, "sse2") == 0)
+    {
+        return __builtin_cpu_supports("sse2");
+    }
+    if (strcmp(k->feature, "avx2") == 0)
+    {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+    }
+    if (strcmp(k->feature, "avx512bw") == 0)
+    {
+        return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("bmi");
+    }
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+SELECT BEST KERNEL (DISPATCH)
+-----------------------------------------------------------------
+*/
+static const struct kernel *select_kernel(void)
+{
+    const struct kernel *best = &kernels[0];
+
+    for (int i = 0; i < KERNEL_COUNT; i++)
+    {
+        if (kernel_supported(&kernels[i]))
+        {
+            best = &kernels[i];
+        }
+    }
+    return best;
+}
+
+/*
+-----------------------------------------------------------------
+REFERENCE COUNTERS: NAIVE LOOP AND MEMCHR
+-----------------------------------------------------------------
+*/
+__attribute__((optimize("no-tree-vectorize")))
+static size_t count_naive(const char *buf, size_t len, char delim)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (buf[i] == delim)
+        {
+            n++;
+        }
+    }
+    return n;
+}
+
+static size_t count_memchr(const char *buf, size_t len, char delim)
+{
+    const char *p = buf, *end = buf + len;
+    size_t n = 0;
+
+    while (p < end && (p = memchr(p, delim, end - p)) != NULL)
+    {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+/*
+-----------------------------------------------------------------
+FILE PATH: COUNT LINES VIA read() AND mmap()
+-----------------------------------------------------------------
+*/
+static int scan_file(const char *path, const struct kernel *k)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    /* read() path: stream in chunks */
+    char *buf = malloc(READ_CHUNK);
+    size_t lines_read = 0;
+    ssize_t n;
+
+    if (buf == NULL)
+    {
+        close(fd);
+        return -1;
+    }
+    while ((n = read(fd, buf, READ_CHUNK)) > 0)
+    {
+        lines_read += k->count(buf, n, '\n');
+    }
+    free(buf);
+
+    /* mmap() path: scan in place and build offset table */
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0)
+    {
+        close(fd);
+        printf("File %s: %zu lines (read)\n\n", path, lines_read);
+        return 0;
+    }
+
+    char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("mmap failed");
+        return -1;
+    }
+
+    size_t lines_map = k->count(map, st.st_size, '\n');
+    size_t *offsets = malloc((lines_map + 1) * sizeof(size_t));
+    if (offsets == NULL)
+    {
+        munmap(map, st.st_size);
+        return -1;
+    }
+    offsets[0] = 0;
+    size_t records = 1 + k->index(map, st.st_size, '\n', 0, offsets + 1, lines_map);
+
+    printf("File %s: %zu lines (read), %zu lines (mmap), %zu record offsets\n",
+           path, lines_read, lines_map, records);
+    printf("First records:");
+    for (size_t i = 0; i < records && i < 5; i++)
+    {
+        printf(" [%zu]", offsets[i]);
+    }
+    printf("\n\n");
+
+    free(offsets);
+    munmap(map, st.st_size);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+BENCHMARK HELPER: BEST OF N ROUNDS IN GB/s
+-----------------------------------------------------------------
+*/
+static double bench_count(count_fn fn, const char *buf, size_t len, size_t *result)
+{
+    double best = 1e9;
+
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+    {
+        double t0 = now_sec();
+        *result = fn(buf, len, '\n');
+        double t = now_sec() - t0;
+        if (t < best)
+        {
+            best = t;
+        }
+    }
+    return len / best / 1e9;
+}
+
+static double bench_index(index_fn fn, const char *buf, size_t len,
+                          size_t *offsets, size_t max, size_t *result)
+{
+    double best = 1e9;
+
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+    {
+        double t0 = now_sec();
+        *result = fn(buf, len, '\n', 0, offsets, max);
+        double t = now_sec() - t0;
+        if (t < best)
+        {
+            best = t;
+        }
+    }
+    return len / best / 1e9;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program selects a SIMD kernel and benchmarks it.
+*/
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 1 ? argv[1] : "x.txt";
+    size_t size = (size_t)(argc > 2 ? atoi(argv[2]) : 256) * 1024 * 1024;
+
+    /*
+    STEP 1: Runtime dispatch
+    ------------------------
+    */
+    const struct kernel *best = select_kernel();
+
+    printf("Kernels:");
+    for (int i = 0; i < KERNEL_COUNT; i++)
+    {
+        printf(" %s%s", kernels[i].name, kernel_supported(&kernels[i]) ? "" : "(n/a)");
+    }
+    printf("\nSelected: %s\n\n", best->name);
+
+    /*
+    STEP 2: Scan the real file if present
+    -------------------------------------
+    */
+    if (scan_file(path, best) == -1)
+    {
+        printf("File %s not readable, skipping file scan\n\n", path);
+    }
+
+    /*
+    STEP 3: Synthetic buffer (line length 1..160)
+    ---------------------------------------------
+    */
+    char *buf = malloc(size);
+    if (buf == NULL || size == 0)
+    {
+        perror("malloc failed");
+        return 1;
+    }
+
+    unsigned int seed = 1;
+    for (size_t i = 0; i < size; )
+    {
+        size_t line = 1 + rand_r(&seed) % 160;
+        for (size_t j = 0; j + 1 < line && i < size; j++)
+        {
+            buf[i++] = 'a' + (char)(j % 26);
+        }
+        if (i < size)
+        {
+            buf[i++] = '\n';
+        }
+    }
+
+    /*
+    STEP 4: Line count benchmark
+    ----------------------------
+    */
+    size_t expected = count_naive(buf, size, '\n');
+    size_t got;
+
+    printf("Buffer: %zu MB, %zu lines\n\n", size >> 20, expected);
+    printf("%-10s %12s %12s\n", "kernel", "count GB/s", "index GB/s");
+
+    double gbs = bench_count(count_naive, buf, size, &got);
+    printf("%-10s %12.2f %12s\n", "naive", gbs, "-");
+    gbs = bench_count(count_memchr, buf, size, &got);
+    printf("%-10s %12.2f %12s%s\n", "memchr", gbs, "-", got == expected ? "" : "  MISMATCH");
+
+    /*
+    STEP 5: Each kernel (count + offset table)
+    ------------------------------------------
+    */
+    size_t *offsets = malloc(expected * sizeof(size_t));
+    if (offsets == NULL)
+    {
+        perror("malloc failed");
+        return 1;
+    }
+
+    for (int i = 0; i < KERNEL_COUNT; i++)
+    {
+        size_t indexed;
+
+        if (!kernel_supported(&kernels[i]))
+        {
+            continue;
+        }
+        double count_gbs = bench_count(kernels[i].count, buf, size, &got);
+        double index_gbs = bench_index(kernels[i].index, buf, size, offsets, expected, &indexed);
+
+        printf("%-10s %12.2f %12.2f%s\n", kernels[i].name, count_gbs, index_gbs,
+               got == expected && indexed == expected ? "" : "  MISMATCH");
+    }
+
+    free(offsets);
+    free(buf);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. cmpeq + movemask = one bit per matching byte
+2. popcount(mask) = count, ctz(mask) = next position
+3. target("avx2") compiles one function for a newer CPU
+4. __builtin_cpu_supports() chooses the kernel at runtime
+5. Always keep a scalar fallback and a scalar tail loop
+6. Offset tables are the basis for splitting records
+7. memchr() is fast per call but pays per-match call cost
+
+DEFINITION (IN SIMPLE WORDS):
+Instead of looking at one character at a time, the CPU
+looks at 16, 32 or 64 characters at once and reports
+where the newlines are.
+
+REAL-TIME EXAMPLES:
+- wc -l, ripgrep, simdjson
+- Log shippers splitting lines
+- CSV / TSV parsers
+- Database bulk loaders
+
+=================================================================
+*/
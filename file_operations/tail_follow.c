@@ -0,0 +1,614 @@
+/*
+=================================================================
+TAIL-FOLLOW READER – inotify + pread() (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to follow a growing file like "tail -F"
+2. How inotify IN_MODIFY wakes the reader (no polling loop)
+3. How only the appended range is read with pread()
+4. How truncation is detected (size < our offset)
+5. How rotation (rename + new file) is followed
+6. How bursts of events are handled in one batch
+7. How to measure write-to-delivery latency and idle CPU
+
+DEFINITION:
+inotify lets a process ask the kernel for notifications about
+file system changes. The reader blocks in read() on the
+inotify descriptor and is woken only when the file changes.
+It remembers how far it has read (offset) and reads just the
+new bytes [offset, size) with pread().
+
+SYNTAX (MAJOR CALLS USED):
+int inotify_init1(int flags);
+int inotify_add_watch(int fd, const char *path, uint32_t mask);
+int inotify_rm_watch(int fd, int wd);
+ssize_t pread(int fd, void *buf, size_t count, off_t offset);
+
+SYNTAX EXPLANATION:
+IN_MODIFY         -> File content changed (write, truncate)
+IN_MOVE_SELF      -> The watched file was renamed (rotation)
+IN_DELETE_SELF    -> The watched file was deleted
+IN_CREATE / IN_MOVED_TO on the directory
+                  -> A new file with our name appeared
+struct inotify_event -> wd, mask, len, name[len]
+One read() on the inotify fd returns ALL queued events
+
+KEY POINTS:
+- Each wake-up: read all events, then ONE fstat() and one
+  pread() loop up to the current size (batching)
+- size < offset -> file was truncated -> restart at 0
+- Rotation: drain the old file to its end, then watch and
+  open the new file (watch first, so no write is missed)
+- Lines split across reads are carried over
+- Idle: the reader sleeps in read(), using ~0 CPU
+- Limitation: truncation followed by re-growth past our
+  offset before we wake cannot be seen from the size alone
+
+WHY inotify FOLLOW?
+- Polling with sleep() adds latency AND burns CPU
+- Log shippers need appended data within microseconds
+- Log rotation must not lose or duplicate data
+
+IMPORTANT APIs:
+inotify_init1()   -> Create notification fd
+inotify_add_watch()-> Watch file and its directory
+read()            -> Wait for events (blocks)
+fstat()           -> Current size
+pread()           -> Read appended range
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+Self-test (default):
+STEP 1: Forks a writer that appends timestamped lines in
+        bursts, truncates once and rotates once
+STEP 2: Follows the file with inotify + pread()
+STEP 3: Computes latency (write timestamp -> line received)
+STEP 4: Measures CPU used while the writer is idle
+STEP 5: Prints lines, events, wake-ups, latency percentiles
+
+The self-test uses its own scratch files (tail_follow.log
+and tail_follow.log.1) and removes them at the end.
+
+Follow mode (-f [file], default x.txt):
+Prints appended data to stdout forever (like tail -F);
+the followed file is never modified or removed
+
+COMPILE:
+gcc -O2 tail_follow.c
+./a.out             or      ./a.out -f [file]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Lines sent / received, truncations, rotations
+2. inotify events vs wake-ups vs pread() calls
+3. Latency min / p50 / p99 / max in microseconds
+4. CPU ms used during a 2 s idle period
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>          // For printf(), snprintf()
+#include <stdlib.h>         // For malloc(), qsort()
+#include <string.h>         // For strcmp(), memmove()
+#include <errno.h>          // For errno
+#include <fcntl.h>          // For open()
+#include <libgen.h>         // For dirname(), basename()
+#include <time.h>           // For clock_gettime()
+#include <unistd.h>         // For pread(), write(), fork()
+#include <sys/inotify.h>    // For inotify_*()
+#include <sys/resource.h>   // For getrusage()
+#include <sys/stat.h>       // For fstat()
+#include <sys/wait.h>       // For waitpid()
+
+#define EVENT_BUF      (64 * 1024)
+#define READ_BUF       (256 * 1024)
+#define LINE_MAX_LEN   256
+#define BURSTS         20
+#define BURST_LINES    500
+#define TEST_LOG       "tail_follow.log"
+#define TEST_ROTATED   "tail_follow.log.1"
+
+/*
+Follower state.
+*/
+struct follower
+{
+    const char *path;
+    const char *name;        /* basename of path */
+    int         ifd;         /* inotify fd */
+    int         file_wd;
+    int         dir_wd;
+    int         fd;          /* current file, -1 while rotating */
+    off_t       offset;      /* bytes already delivered */
+
+    /* statistics */
+    unsigned long events;
+    unsigned long wakeups;
+    unsigned long preads;
+    unsigned long truncations;
+    unsigned long rotations;
+};
+
+/*
+What the self-test consumer collects.
+*/
+struct consumer
+{
+    char           carry[LINE_MAX_LEN];
+    size_t         carry_len;
+    unsigned long  lines;
+    long          *latency_us;
+    unsigned long  latency_cap;
+    int            idle_started;
+    int            finished;
+    double         idle_wall;
+    double         idle_cpu;
+    int            echo;       /* follow mode: print data */
+};
+
+/*
+-----------------------------------------------------------------
+CLOCK HELPERS
+-----------------------------------------------------------------
+*/
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double cpu_seconds(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+CONSUME ONE COMPLETE LINE
+-----------------------------------------------------------------
+"<ns> <seq>", "IDLE" or "END"
+*/
+static void consume_line(struct consumer *c, const char *line)
+{
+    unsigned long long ts;
+
+    if (strcmp(line, "IDLE") == 0)
+    {
+        c->idle_started = 1;
+        c->idle_wall = now_ns() / 1e9;
+        c->idle_cpu = cpu_seconds();
+        return;
+    }
+    if (strcmp(line, "END") == 0)
+    {
+        c->idle_wall = now_ns() / 1e9 - c->idle_wall;
+        c->idle_cpu = cpu_seconds() - c->idle_cpu;
+        c->finished = 1;
+        return;
+    }
+    if (sscanf(line, "%llu", &ts) == 1 && c->lines < c->latency_cap)
+    {
+        c->latency_us[c->lines] = (long)((now_ns() - ts) / 1000);
+    }
+    c->lines++;
+}
+
+/*
+-----------------------------------------------------------------
+DELIVER NEW BYTES (SPLIT INTO LINES)
+-----------------------------------------------------------------
+*/
+static void deliver(struct consumer *c, const char *data, size_t len)
+{
+    if (c->echo)
+    {
+        fwrite(data, 1, len, stdout);
+        fflush(stdout);
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] == '\n')
+        {
+            c->carry[c->carry_len] = '\0';
+            consume_line(c, c->carry);
+            c->carry_len = 0;
+        }
+        else if (c->carry_len < LINE_MAX_LEN - 1)
+        {
+            c->carry[c->carry_len++] = data[i];
+        }
+    }
+}
+
+/*
+-----------------------------------------------------------------
+READ EVERYTHING FROM offset TO CURRENT END
+-----------------------------------------------------------------
+*/
+static void drain(struct follower *f, struct consumer *c, char *buf)
+{
+    struct stat st;
+
+    if (f->fd == -1 || fstat(f->fd, &st) == -1)
+    {
+        return;
+    }
+
+    /* File shrank: it was truncated, start again */
+    if (st.st_size < f->offset)
+    {
+        f->truncations++;
+        f->offset = 0;
+        c->carry_len = 0;
+    }
+
+    while (f->offset < st.st_size)
+    {
+        ssize_t n = pread(f->fd, buf, READ_BUF, f->offset);
+        f->preads++;
+        if (n <= 0)
+        {
+            break;
+        }
+        f->offset += n;
+        deliver(c, buf, n);
+
+        /* Writer may have appended more in the meantime */
+        if (f->offset >= st.st_size && fstat(f->fd, &st) == -1)
+        {
+            break;
+        }
+    }
+}
+
+/*
+-----------------------------------------------------------------
+OPEN (OR REOPEN AFTER ROTATION) THE FOLLOWED FILE
+-----------------------------------------------------------------
+Watch first, then open: a write between the two still
+produces an event for the new watch.
+*/
+static int follower_open(struct follower *f)
+{
+    int wd = inotify_add_watch(f->ifd, f->path, IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF);
+    if (wd == -1)
+    {
+        return -1;
+    }
+
+    int fd = open(f->path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        inotify_rm_watch(f->ifd, wd);
+        return -1;
+    }
+
+    f->file_wd = wd;
+    f->fd = fd;
+    f->offset = 0;
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+FOLLOW LOOP
+-----------------------------------------------------------------
+Blocks in read() on the inotify fd. Returns when the
+consumer has seen "END" (self-test) or on error.
+*/
+static int follow(struct follower *f, struct consumer *c)
+{
+    char *events = malloc(EVENT_BUF);
+    char *buf = malloc(READ_BUF);
+
+    if (events == NULL || buf == NULL)
+    {
+        free(events);
+        free(buf);
+        return -1;
+    }
+
+    drain(f, c, buf);   /* content that existed before we started */
+
+    while (!c->finished)
+    {
+        ssize_t n = read(f->ifd, events, EVENT_BUF);
+        int moved = 0, created = 0;
+
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        f->wakeups++;
+
+        /* Look at the whole batch first */
+        for (char *p = events; p < events + n; )
+        {
+            struct inotify_event *ev = (struct inotify_event *)p;
+
+            f->events++;
+            if (ev->wd == f->file_wd && (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF)))
+            {
+                moved = 1;
+            }
+            if (ev->wd == f->dir_wd && ev->len > 0 && strcmp(ev->name, f->name) == 0)
+            {
+                created = 1;
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+
+        /* One read pass for the whole batch */
+        drain(f, c, buf);
+
+        if (moved && f->fd != -1)
+        {
+            /* Old file is complete: the writer moved on */
+            drain(f, c, buf);
+            inotify_rm_watch(f->ifd, f->file_wd);
+            close(f->fd);
+            f->fd = -1;
+            f->rotations++;
+        }
+        if (f->fd == -1 && (moved || created))
+        {
+            if (follower_open(f) == 0)
+            {
+                c->carry_len = 0;
+                drain(f, c, buf);
+            }
+        }
+    }
+
+    free(events);
+    free(buf);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+SELF-TEST WRITER (CHILD PROCESS)
+-----------------------------------------------------------------
+Bursts of timestamped lines; truncates after burst 10,
+rotates after burst 15; then idles 2 s.
+*/
+static void writer_main(const char *path, const char *rotated)
+{
+    char line[64];
+    unsigned long seq = 0;
+    struct timespec pause = { 0, 10 * 1000 * 1000 };
+
+    int fd = open(path, O_CREAT | O_WRONLY | O_APPEND, 0644);
+    if (fd == -1)
+    {
+        _exit(1);
+    }
+
+    for (int burst = 0; burst < BURSTS; burst++)
+    {
+        for (int i = 0; i < BURST_LINES; i++)
+        {
+            int len = snprintf(line, sizeof(line), "%llu %lu\n", now_ns(), seq++);
+            if (write(fd, line, len) != len)
+            {
+                _exit(1);
+            }
+        }
+        nanosleep(&pause, NULL);
+
+        if (burst == 9 && ftruncate(fd, 0) == -1)
+        {
+            _exit(1);
+        }
+        if (burst == 14)
+        {
+            /* Rotation: move away, start a new file */
+            if (rename(path, rotated) == -1)
+            {
+                _exit(1);
+            }
+            close(fd);
+            fd = open(path, O_CREAT | O_WRONLY | O_APPEND, 0644);
+            if (fd == -1)
+            {
+                _exit(1);
+            }
+        }
+    }
+
+    if (write(fd, "IDLE\n", 5) != 5)
+    {
+        _exit(1);
+    }
+    sleep(2);
+    if (write(fd, "END\n", 4) != 4)
+    {
+        _exit(1);
+    }
+    close(fd);
+    _exit(0);
+}
+
+static int compare_long(const void *a, const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+-----------------------------------------------------------------
+SET UP FOLLOWER: inotify FD, DIRECTORY WATCH, FIRST OPEN
+-----------------------------------------------------------------
+*/
+static int follower_init(struct follower *f, const char *path, char *dir_copy, char *name_copy)
+{
+    memset(f, 0, sizeof(*f));
+    f->path = path;
+    f->name = basename(name_copy);
+    f->fd = -1;
+
+    f->ifd = inotify_init1(IN_CLOEXEC);
+    if (f->ifd == -1)
+    {
+        return -1;
+    }
+    f->dir_wd = inotify_add_watch(f->ifd, dirname(dir_copy), IN_CREATE | IN_MOVED_TO);
+    if (f->dir_wd == -1)
+    {
+        return -1;
+    }
+    follower_open(f);   /* file may not exist yet */
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program follows a growing file with inotify.
+*/
+int main(int argc, char *argv[])
+{
+    struct follower f;
+    struct consumer c;
+    char dir_copy[4096], name_copy[4096];
+    int follow_mode = argc > 1 && strcmp(argv[1], "-f") == 0;
+    const char *path = follow_mode ? (argc > 2 ? argv[2] : "x.txt") : TEST_LOG;
+
+    if (!follow_mode && argc > 1)
+    {
+        fprintf(stderr, "usage: %s            (self-test)\n"
+                        "       %s -f [file]  (follow, default x.txt)\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    snprintf(dir_copy, sizeof(dir_copy), "%s", path);
+    snprintf(name_copy, sizeof(name_copy), "%s", path);
+    memset(&c, 0, sizeof(c));
+
+    /*
+    Follow mode: like tail -F
+    -------------------------
+    */
+    if (follow_mode)
+    {
+        c.echo = 1;
+        if (follower_init(&f, path, dir_copy, name_copy) == -1)
+        {
+            perror("inotify failed");
+            return 1;
+        }
+        return follow(&f, &c) == -1 ? 1 : 0;
+    }
+
+    /*
+    STEP 1: Writer child (on our own scratch files)
+    -----------------------------------------------
+    */
+    const char *rotated = TEST_ROTATED;
+    unlink(path);
+    unlink(rotated);
+
+    c.latency_cap = BURSTS * BURST_LINES;
+    c.latency_us = malloc(c.latency_cap * sizeof(long));
+
+    int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1 || c.latency_us == NULL)
+    {
+        perror("setup failed");
+        return 1;
+    }
+    close(fd);
+
+    if (follower_init(&f, path, dir_copy, name_copy) == -1)
+    {
+        perror("inotify failed");
+        unlink(path);
+        return 1;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        perror("fork failed");
+        unlink(path);
+        return 1;
+    }
+    if (pid == 0)
+    {
+        writer_main(path, rotated);
+    }
+
+    /*
+    STEP 2 + 3 + 4: Follow until END
+    --------------------------------
+    */
+    follow(&f, &c);
+    waitpid(pid, NULL, 0);
+
+    /*
+    STEP 5: Report
+    --------------
+    */
+    unsigned long samples = c.lines < c.latency_cap ? c.lines : c.latency_cap;
+    qsort(c.latency_us, samples, sizeof(long), compare_long);
+
+    printf("Lines: sent %d, received %lu\n", BURSTS * BURST_LINES, c.lines);
+    printf("Truncations seen: %lu, rotations followed: %lu\n", f.truncations, f.rotations);
+    printf("inotify events: %lu, wake-ups: %lu, pread calls: %lu (%.1f events per wake-up)\n",
+           f.events, f.wakeups, f.preads, f.wakeups ? (double)f.events / f.wakeups : 0.0);
+    if (samples > 0)
+    {
+        printf("Latency us: min %ld, p50 %ld, p99 %ld, max %ld\n", c.latency_us[0],
+               c.latency_us[samples / 2], c.latency_us[samples * 99 / 100],
+               c.latency_us[samples - 1]);
+    }
+    printf("Idle: %.0f ms CPU over %.2f s wall\n", c.idle_cpu * 1e3, c.idle_wall);
+
+    free(c.latency_us);
+    unlink(path);
+    unlink(rotated);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. inotify_add_watch(IN_MODIFY) -> wake on every change
+2. read() on inotify fd blocks: no sleep/poll loop, ~0 idle CPU
+3. One read() returns a batch of events -> one pread pass
+4. Keep an offset; read only [offset, size)
+5. size < offset -> truncated -> offset = 0
+6. IN_MOVE_SELF -> drain old file, then open the new one
+7. Watch the directory to see the new file appear
+
+DEFINITION (IN SIMPLE WORDS):
+Instead of checking the file again and again, ask the
+kernel to ring a bell whenever it changes, then read
+only the part that is new.
+
+REAL-TIME EXAMPLES:
+- tail -F, journal / log viewers
+- Log shippers (Filebeat, Fluent Bit, Vector)
+- Build tools and dev servers watching files
+- Monitoring agents following application logs
+
+=================================================================
+*/
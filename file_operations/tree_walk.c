@@ -0,0 +1,619 @@
+/*
+=================================================================
+PARALLEL DIRECTORY TREE WALK – getdents64() + openat() (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to read directories with the raw getdents64() syscall
+2. How to read MANY entries per syscall (64 KB batches)
+3. How openat() opens a child relative to its parent dirfd
+4. How d_type classifies entries without stat()
+5. How subdirectories are spread across a thread pool
+6. How this compares with nftw() and fts (entries / second)
+
+DEFINITION:
+readdir() is a libc wrapper around getdents64(). Calling the
+syscall directly lets the program choose a large buffer and
+avoid per-entry overhead. openat(dirfd, name) resolves only
+ONE path component, instead of walking the whole path from
+"/" again for every directory.
+
+SYNTAX (MAJOR CALLS USED):
+long syscall(SYS_getdents64, int fd, void *buf, size_t count);
+int  openat(int dirfd, const char *name, int flags);
+int  fstatat(int dirfd, const char *name, struct stat *st,
+             int flags);
+
+SYNTAX EXPLANATION:
+getdents64()      -> Fills buf with struct linux_dirent64
+                     records; returns bytes used, 0 at end
+d_reclen          -> Size of this record (step to the next)
+d_type            -> DT_DIR, DT_REG, DT_LNK ... or DT_UNKNOWN
+O_DIRECTORY       -> Fail unless it is a directory
+O_NOFOLLOW        -> Do not follow symlinks (no loops)
+fstatat()         -> Only used when d_type == DT_UNKNOWN
+
+KEY POINTS:
+- Each directory is one task: { parent node, name }
+- Parent dirfd is reference counted; it is closed when the
+  last child has been opened
+- Work list is LIFO (depth first) to keep few fds open
+- No stat() per file: d_type comes with the directory entry
+- Symlinks are counted, never followed
+- RLIMIT_NOFILE is raised for wide trees
+
+WHY getdents64 + openat?
+- Fewer syscalls (one per ~1000 entries, not per entry)
+- No full path resolution per directory
+- Independent subtrees can be listed in parallel
+
+IMPORTANT APIs:
+getdents64()      -> Batch directory read
+openat()          -> Relative open
+nftw()            -> POSIX tree walk (reference)
+fts_open()/fts_read() -> BSD tree walk (reference)
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Creates a test tree if the directory is missing
+STEP 2: Warm-up walk (dentry / inode cache)
+STEP 3: Walks with nftw() and with fts
+STEP 4: Walks with getdents64 + openat on 1, 2, 4 ... threads
+STEP 5: Prints entries, dirs, files, ms and entries / second
+
+COMPILE:
+gcc -O2 -pthread tree_walk.c
+./a.out [directory] [files_if_created] [max_threads]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Tree summary (directories, files, symlinks)
+2. Table: method, threads, entries, ms, entries/s
+   (all methods report the same entry count)
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), perror()
+#include <stdlib.h>       // For malloc(), free(), atoi()
+#include <string.h>       // For strlen(), memcpy()
+#include <dirent.h>       // For DT_* constants
+#include <fcntl.h>        // For openat(), O_DIRECTORY
+#include <fts.h>          // For fts_open(), fts_read()
+#include <ftw.h>          // For nftw()
+#include <pthread.h>      // For pthreads
+#include <stdatomic.h>    // For atomic counters
+#include <time.h>         // For clock_gettime()
+#include <unistd.h>       // For close(), syscall()
+#include <sys/resource.h> // For setrlimit()
+#include <sys/stat.h>     // For mkdirat(), fstatat()
+#include <sys/syscall.h>  // For SYS_getdents64
+
+#define DENTS_BUF     (64 * 1024)
+#define MAX_THREADS   256
+
+/*
+Record layout returned by getdents64().
+*/
+struct linux_dirent64
+{
+    unsigned long long d_ino;
+    long long          d_off;
+    unsigned short     d_reclen;
+    unsigned char      d_type;
+    char               d_name[];
+};
+
+/*
+An open directory; children hold a reference until they
+have been opened with openat().
+*/
+struct dir_node
+{
+    int        fd;
+    atomic_int refs;
+};
+
+/*
+A directory waiting to be listed.
+*/
+struct dir_task
+{
+    struct dir_task *next;
+    struct dir_node *parent;
+    char             name[];
+};
+
+/*
+Walk totals (per thread, summed at the end).
+*/
+struct walk_stats
+{
+    unsigned long entries;
+    unsigned long dirs;
+    unsigned long files;
+    unsigned long links;
+    unsigned long other;
+};
+
+/* Shared LIFO work list */
+static pthread_mutex_t list_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  list_cond = PTHREAD_COND_INITIALIZER;
+static struct dir_task *work_list;
+static long outstanding;   /* queued + running tasks */
+
+/* Counters for the nftw / fts callbacks */
+static struct walk_stats ref_stats;
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+COUNT ONE ENTRY BY TYPE
+-----------------------------------------------------------------
+*/
+static void count_entry(struct walk_stats *s, unsigned char type)
+{
+    s->entries++;
+    switch (type)
+    {
+    case DT_DIR: s->dirs++;  break;
+    case DT_REG: s->files++; break;
+    case DT_LNK: s->links++; break;
+    default:     s->other++; break;
+    }
+}
+
+/*
+-----------------------------------------------------------------
+DIRECTORY NODE REFERENCE COUNTING
+-----------------------------------------------------------------
+*/
+static void node_put(struct dir_node *node)
+{
+    if (node != NULL && atomic_fetch_sub(&node->refs, 1) == 1)
+    {
+        close(node->fd);
+        free(node);
+    }
+}
+
+/*
+-----------------------------------------------------------------
+WORK LIST: PUSH / POP
+-----------------------------------------------------------------
+*/
+static void push_task(struct dir_node *parent, const char *name, size_t len)
+{
+    struct dir_task *t = malloc(sizeof(struct dir_task) + len + 1);
+
+    if (t == NULL)
+    {
+        return;
+    }
+    memcpy(t->name, name, len + 1);
+    t->parent = parent;
+    atomic_fetch_add(&parent->refs, 1);
+
+    pthread_mutex_lock(&list_lock);
+    t->next = work_list;
+    work_list = t;
+    outstanding++;
+    pthread_cond_signal(&list_cond);
+    pthread_mutex_unlock(&list_lock);
+}
+
+/* Returns NULL when the whole tree is done */
+static struct dir_task *pop_task(void)
+{
+    struct dir_task *t;
+
+    pthread_mutex_lock(&list_lock);
+    while (work_list == NULL && outstanding > 0)
+    {
+        pthread_cond_wait(&list_cond, &list_lock);
+    }
+    t = work_list;
+    if (t != NULL)
+    {
+        work_list = t->next;
+    }
+    pthread_mutex_unlock(&list_lock);
+
+    return t;
+}
+
+static void task_done(void)
+{
+    pthread_mutex_lock(&list_lock);
+    if (--outstanding == 0)
+    {
+        pthread_cond_broadcast(&list_cond);
+    }
+    pthread_mutex_unlock(&list_lock);
+}
+
+/*
+-----------------------------------------------------------------
+LIST ONE DIRECTORY WITH getdents64()
+-----------------------------------------------------------------
+Subdirectories become new tasks; everything else is counted.
+*/
+static void list_directory(struct dir_node *node, char *buf, struct walk_stats *s)
+{
+    long n;
+
+    while ((n = syscall(SYS_getdents64, node->fd, buf, DENTS_BUF)) > 0)
+    {
+        for (long pos = 0; pos < n; )
+        {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(buf + pos);
+            unsigned char type = d->d_type;
+
+            pos += d->d_reclen;
+            if (d->d_name[0] == '.' &&
+                (d->d_name[1] == '\0' || (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+            {
+                continue;
+            }
+
+            /* Some filesystems do not fill d_type */
+            if (type == DT_UNKNOWN)
+            {
+                struct stat st;
+                if (fstatat(node->fd, d->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+                {
+                    type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG :
+                           S_ISLNK(st.st_mode) ? DT_LNK : DT_UNKNOWN;
+                }
+            }
+
+            count_entry(s, type);
+            if (type == DT_DIR)
+            {
+                push_task(node, d->d_name, strlen(d->d_name));
+            }
+        }
+    }
+}
+
+/*
+-----------------------------------------------------------------
+WALKER THREAD
+-----------------------------------------------------------------
+*/
+static void *walker_main(void *arg)
+{
+    struct walk_stats *s = arg;
+    char *buf = malloc(DENTS_BUF);
+    struct dir_task *t;
+
+    if (buf == NULL)
+    {
+        return NULL;
+    }
+
+    while ((t = pop_task()) != NULL)
+    {
+        int fd = openat(t->parent->fd, t->name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+        node_put(t->parent);
+        free(t);
+
+        if (fd != -1)
+        {
+            struct dir_node *node = malloc(sizeof(struct dir_node));
+            if (node == NULL)
+            {
+                close(fd);
+                task_done();
+                continue;
+            }
+            node->fd = fd;
+            atomic_init(&node->refs, 1);   /* our own reference */
+            list_directory(node, buf, s);
+            node_put(node);
+        }
+        task_done();
+    }
+
+    free(buf);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+PARALLEL WALK
+-----------------------------------------------------------------
+The root becomes the first task; its parent is "." or "/".
+An all-slash root is walked as "." relative to "/".
+*/
+static int parallel_walk(const char *root, int threads, struct walk_stats *total)
+{
+    struct walk_stats stats[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    struct dir_node *start = malloc(sizeof(struct dir_node));
+
+    if (start == NULL)
+    {
+        return -1;
+    }
+    start->fd = open(root[0] == '/' ? "/" : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (start->fd == -1)
+    {
+        free(start);
+        return -1;
+    }
+    atomic_init(&start->refs, 1);
+
+    /* Name relative to the start fd; "/" itself becomes "." */
+    const char *name = root;
+    while (*name == '/')
+    {
+        name++;
+    }
+    if (*name == '\0')
+    {
+        name = ".";
+    }
+    push_task(start, name, strlen(name));
+    node_put(start);
+
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_create(&tid[i], NULL, walker_main, &stats[i]);
+    }
+
+    memset(total, 0, sizeof(*total));
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(tid[i], NULL);
+        total->entries += stats[i].entries;
+        total->dirs += stats[i].dirs;
+        total->files += stats[i].files;
+        total->links += stats[i].links;
+        total->other += stats[i].other;
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+REFERENCE WALKS: nftw() AND fts
+-----------------------------------------------------------------
+The root itself is not counted, same as the parallel walk.
+*/
+static int nftw_callback(const char *path, const struct stat *st, int flag, struct FTW *ftw)
+{
+    (void)path;
+    (void)st;
+
+    if (ftw->level > 0)
+    {
+        count_entry(&ref_stats, flag == FTW_D || flag == FTW_DNR ? DT_DIR :
+                                flag == FTW_SL ? DT_LNK : flag == FTW_F ? DT_REG : DT_UNKNOWN);
+    }
+    return 0;
+}
+
+static int fts_walk(const char *root)
+{
+    char *paths[] = { (char *)root, NULL };
+    FTS *fts = fts_open(paths, FTS_PHYSICAL | FTS_NOSTAT | FTS_NOCHDIR, NULL);
+    FTSENT *e;
+
+    if (fts == NULL)
+    {
+        return -1;
+    }
+    while ((e = fts_read(fts)) != NULL)
+    {
+        if (e->fts_level == 0 || e->fts_info == FTS_DP)
+        {
+            continue;   /* root, and post-order visit of directories */
+        }
+        count_entry(&ref_stats, e->fts_info == FTS_D ? DT_DIR :
+                                e->fts_info == FTS_SL ? DT_LNK :
+                                e->fts_info == FTS_F || e->fts_info == FTS_NSOK ? DT_REG :
+                                DT_UNKNOWN);
+    }
+    fts_close(fts);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+CREATE TEST TREE
+-----------------------------------------------------------------
+3 levels x 10 subdirectories = 1110 directories, files spread
+over the 1000 leaves, plus one symlink per leaf.
+*/
+static int create_tree(const char *root, int files)
+{
+    char path[4096];
+
+    if (mkdir(root, 0755) == -1)
+    {
+        return -1;
+    }
+    for (int a = 0; a < 10; a++)
+    {
+        snprintf(path, sizeof(path), "%s/%d", root, a);
+        mkdir(path, 0755);
+        for (int b = 0; b < 10; b++)
+        {
+            snprintf(path, sizeof(path), "%s/%d/%d", root, a, b);
+            mkdir(path, 0755);
+            for (int c = 0; c < 10; c++)
+            {
+                snprintf(path, sizeof(path), "%s/%d/%d/%d", root, a, b, c);
+                mkdir(path, 0755);
+                snprintf(path, sizeof(path), "%s/%d/%d/%d/up", root, a, b, c);
+                if (symlink("..", path) == -1)
+                {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    for (int f = 0; f < files; f++)
+    {
+        int leaf = f % 1000;
+        snprintf(path, sizeof(path), "%s/%d/%d/%d/file%07d", root,
+                 leaf / 100, leaf / 10 % 10, leaf % 10, f);
+        int fd = open(path, O_CREAT | O_WRONLY, 0644);
+        if (fd == -1)
+        {
+            return -1;
+        }
+        close(fd);
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+PRINT ONE RESULT ROW
+-----------------------------------------------------------------
+*/
+static void print_row(const char *method, int threads, const struct walk_stats *s, double ms)
+{
+    printf("%-12s %7d %10lu %9.1f %12.0f\n", method, threads, s->entries, ms,
+           s->entries / (ms / 1e3));
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares tree walk strategies.
+*/
+int main(int argc, char *argv[])
+{
+    const char *root = argc > 1 ? argv[1] : "walk_data";
+    int files = argc > 2 ? atoi(argv[2]) : 200000;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = argc > 3 ? atoi(argv[3]) : (cores > 4 ? cores : 4);
+    struct walk_stats total;
+    double t0, ms;
+
+    if (max_threads < 1 || max_threads > MAX_THREADS)
+    {
+        max_threads = MAX_THREADS;
+    }
+
+    /* Wide trees keep many parent dirfds open */
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    /*
+    STEP 1: Test tree
+    -----------------
+    */
+    if (access(root, F_OK) == -1)
+    {
+        printf("Creating %s with %d files...\n", root, files);
+        if (create_tree(root, files) == -1)
+        {
+            perror("create tree failed");
+            return 1;
+        }
+    }
+
+    /*
+    STEP 2: Warm-up
+    ---------------
+    */
+    if (parallel_walk(root, 1, &total) == -1)
+    {
+        perror("open failed");
+        return 1;
+    }
+    printf("Tree %s: %lu entries (%lu dirs, %lu files, %lu symlinks, %lu other)\n\n",
+           root, total.entries, total.dirs, total.files, total.links, total.other);
+
+    printf("%-12s %7s %10s %9s %12s\n", "method", "threads", "entries", "ms", "entries/s");
+
+    /*
+    STEP 3: nftw() and fts
+    ----------------------
+    */
+    memset(&ref_stats, 0, sizeof(ref_stats));
+    t0 = now_ms();
+    if (nftw(root, nftw_callback, 64, FTW_PHYS) == -1)
+    {
+        perror("nftw failed");
+        return 1;
+    }
+    print_row("nftw", 1, &ref_stats, now_ms() - t0);
+
+    memset(&ref_stats, 0, sizeof(ref_stats));
+    t0 = now_ms();
+    if (fts_walk(root) == -1)
+    {
+        perror("fts_open failed");
+        return 1;
+    }
+    print_row("fts", 1, &ref_stats, now_ms() - t0);
+
+    /*
+    STEP 4 + 5: getdents64 + openat on a thread pool
+    ------------------------------------------------
+    */
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        t0 = now_ms();
+        parallel_walk(root, threads, &total);
+        ms = now_ms() - t0;
+        print_row("getdents64", threads, &total, ms);
+    }
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. getdents64() returns many entries per syscall
+2. Step through records with d_reclen
+3. d_type avoids one stat() per entry (check DT_UNKNOWN)
+4. openat(parent_fd, name) resolves a single component
+5. O_NOFOLLOW + DT_LNK: never follow symlinks (no loops)
+6. Directories are independent -> list them in parallel
+7. nftw() stats every entry; fts with FTS_NOSTAT does not
+
+DEFINITION (IN SIMPLE WORDS):
+Read each folder in big gulps, open sub-folders relative
+to the folder you already have open, and let several
+threads explore different branches at the same time.
+
+REAL-TIME EXAMPLES:
+- find, fd, ripgrep, du
+- Backup and sync tools (rsync, restic)
+- Indexers and antivirus scanners
+- Build systems checking source trees
+
+=================================================================
+*/
@@ -0,0 +1,741 @@
+/*
+=================================================================
+WORK-STEALING THREAD POOL – PARALLEL MULTI-FILE PROCESSING
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How open() -> read() -> process -> close() runs as a task
+2. How every worker owns a Chase-Lev work-stealing deque
+3. How idle workers steal tasks from busy workers
+4. How directories become tasks that create more tasks
+5. How scaling and load balance compare with ONE shared queue
+
+DEFINITION:
+A work-stealing pool gives each worker thread its own
+double-ended queue (deque). The owner pushes and pops tasks
+at the bottom, without locks and without contention. A worker
+that runs out of work picks a random victim and steals from
+the TOP of the victim's deque. Busy workers are only touched
+when someone is idle, so the pool balances itself.
+
+SYNTAX (MAJOR CALLS USED):
+int   pthread_create(pthread_t *t, const pthread_attr_t *attr,
+                     void *(*fn)(void *), void *arg);
+DIR  *opendir(const char *name);
+struct dirent *readdir(DIR *dirp);
+int   open(const char *path, int flags);
+ssize_t read(int fd, void *buf, size_t count);
+
+SYNTAX EXPLANATION:
+Chase-Lev deque   -> bottom: only the owner moves it (push / take)
+                     top   : thieves move it with a CAS (steal)
+                     array : circular buffer, grows when full
+
+take()            -> Owner pops newest task (LIFO, cache-warm)
+steal()           -> Thief takes oldest task (FIFO, big subtrees)
+
+pending           -> Atomic count of unfinished tasks;
+                     workers stop when it reaches 0
+
+d_type            -> DT_DIR / DT_REG from readdir(), no stat()
+
+KEY POINTS:
+- Task types: DIRECTORY (list entries) and FILE (process file)
+- A directory task pushes its children onto the local deque
+- Only the root task is given to worker 0; the rest is stolen
+- Memory orders follow "Correct and Efficient Work-Stealing
+  for Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli)
+- Shared-queue mode: one mutex + condition variable for all
+- Per-worker task counts show the load balance
+
+WHY WORK STEALING?
+- No central lock: scales with the number of cores
+- Recursive work (directory trees) spreads automatically
+- Local LIFO order keeps caches warm
+
+IMPORTANT APIs:
+pthread_create()  -> Worker threads
+opendir()/readdir()-> Enumerate directory
+open()/read()     -> Read file content
+close()           -> Release file descriptor
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Creates a test tree of mixed-size files if needed
+STEP 2: Warm-up pass so all files are in the page cache
+STEP 3: For 1, 2, 4, ... threads:
+        a) runs the shared-queue pool
+        b) runs the work-stealing pool
+STEP 4: Prints time, files/s, MB/s, steals, and the
+        min / max tasks per worker (load balance)
+
+COMPILE:
+gcc -O2 -pthread work_stealing_pool.c
+./a.out [directory] [files_if_created] [max_threads]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Tree summary: files and total size
+2. Table per thread count and mode: ms, files/s, MB/s,
+   steals, min / max tasks per worker
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), snprintf(), perror()
+#include <stdlib.h>       // For malloc(), free(), atoi()
+#include <string.h>       // For strcmp(), strlen(), memset()
+#include <dirent.h>       // For opendir(), readdir(), dirfd()
+#include <fcntl.h>        // For open(), AT_SYMLINK_NOFOLLOW
+#include <pthread.h>      // For pthreads
+#include <sched.h>        // For sched_yield()
+#include <stdatomic.h>    // For atomic_* operations
+#include <time.h>         // For clock_gettime()
+#include <unistd.h>       // For read(), close()
+#include <sys/stat.h>     // For mkdir(), fstatat()
+
+#define MAX_WORKERS     256
+#define DEQUE_INITIAL   1024
+#define READ_BUF        65536
+
+enum task_type { TASK_DIR, TASK_FILE };
+
+/*
+One unit of work: a directory to list or a file to process.
+*/
+struct task
+{
+    enum task_type type;
+    char           path[];
+};
+
+/*
+Circular buffer of a deque; replaced (never freed while the
+pool runs) when the deque grows.
+*/
+struct deque_array
+{
+    long                 size;
+    struct deque_array  *prev;
+    _Atomic(struct task *) buf[];
+};
+
+/*
+Chase-Lev work-stealing deque.
+*/
+struct deque
+{
+    atomic_long                  top __attribute__((aligned(64)));
+    atomic_long                  bottom __attribute__((aligned(64)));
+    _Atomic(struct deque_array *) array;
+};
+
+/*
+Per-worker state and statistics.
+*/
+struct worker
+{
+    pthread_t      thread;
+    int            id;
+    struct deque   deque;
+    unsigned int   seed;
+    unsigned long  tasks;
+    unsigned long  files;
+    unsigned long  bytes;
+    unsigned long  steals;
+    unsigned long  checksum;
+};
+
+/*
+Shared queue used by the comparison mode.
+*/
+struct shared_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    struct task   **items;
+    long            head, tail, capacity;
+};
+
+/* Pool state */
+static struct worker workers[MAX_WORKERS];
+static int worker_count;
+static int use_stealing;
+static atomic_long pending;
+static struct shared_queue shared;
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+CREATE TASK
+-----------------------------------------------------------------
+*/
+static struct task *task_new(enum task_type type, const char *dir, const char *name)
+{
+    size_t len = strlen(dir) + (name ? strlen(name) + 1 : 0) + 1;
+    struct task *t = malloc(sizeof(struct task) + len);
+
+    if (t == NULL)
+    {
+        return NULL;
+    }
+    t->type = type;
+    if (name != NULL)
+    {
+        snprintf(t->path, len, "%s/%s", dir, name);
+    }
+    else
+    {
+        snprintf(t->path, len, "%s", dir);
+    }
+    return t;
+}
+
+/*
+-----------------------------------------------------------------
+CHASE-LEV DEQUE
+-----------------------------------------------------------------
+*/
+static struct deque_array *array_new(long size)
+{
+    struct deque_array *a = calloc(1, sizeof(struct deque_array) + size * sizeof(struct task *));
+
+    if (a != NULL)
+    {
+        a->size = size;
+    }
+    return a;
+}
+
+static void deque_init(struct deque *d)
+{
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+    atomic_init(&d->array, array_new(DEQUE_INITIAL));
+}
+
+static void deque_destroy(struct deque *d)
+{
+    struct deque_array *a = atomic_load(&d->array);
+
+    while (a != NULL)
+    {
+        struct deque_array *prev = a->prev;
+        free(a);
+        a = prev;
+    }
+}
+
+/* Owner only: push at bottom, grow when full */
+static void deque_push(struct deque *d, struct task *t)
+{
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    struct deque_array *a = atomic_load_explicit(&d->array, memory_order_relaxed);
+
+    if (b - top > a->size - 1)
+    {
+        struct deque_array *bigger = array_new(a->size * 2);
+
+        for (long i = top; i < b; i++)
+        {
+            atomic_store_explicit(&bigger->buf[i % bigger->size],
+                                  atomic_load_explicit(&a->buf[i % a->size], memory_order_relaxed),
+                                  memory_order_relaxed);
+        }
+        bigger->prev = a;   /* thieves may still read the old one */
+        atomic_store_explicit(&d->array, bigger, memory_order_release);
+        a = bigger;
+    }
+
+    atomic_store_explicit(&a->buf[b % a->size], t, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+}
+
+/* Owner only: pop newest task from bottom */
+static struct task *deque_take(struct deque *d)
+{
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    struct deque_array *a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    struct task *t = NULL;
+
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (top <= b)
+    {
+        t = atomic_load_explicit(&a->buf[b % a->size], memory_order_relaxed);
+        if (top == b)
+        {
+            /* Last element: race against thieves */
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                                                         memory_order_seq_cst,
+                                                         memory_order_relaxed))
+            {
+                t = NULL;
+            }
+            atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        }
+    }
+    else
+    {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return t;
+}
+
+/* Any thread: steal oldest task from top */
+static struct task *deque_steal(struct deque *d)
+{
+    long top = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (top < b)
+    {
+        struct deque_array *a = atomic_load_explicit(&d->array, memory_order_acquire);
+        struct task *t = atomic_load_explicit(&a->buf[top % a->size], memory_order_relaxed);
+
+        if (atomic_compare_exchange_strong_explicit(&d->top, &top, top + 1,
+                                                    memory_order_seq_cst,
+                                                    memory_order_relaxed))
+        {
+            return t;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+SHARED QUEUE (COMPARISON MODE)
+-----------------------------------------------------------------
+*/
+static void shared_push(struct task *t)
+{
+    pthread_mutex_lock(&shared.lock);
+    if (shared.tail - shared.head == shared.capacity)
+    {
+        long capacity = shared.capacity ? shared.capacity * 2 : DEQUE_INITIAL;
+        struct task **items = malloc(capacity * sizeof(struct task *));
+
+        for (long i = shared.head; i < shared.tail; i++)
+        {
+            items[i - shared.head] = shared.items[i % shared.capacity];
+        }
+        free(shared.items);
+        shared.items = items;
+        shared.tail -= shared.head;
+        shared.head = 0;
+        shared.capacity = capacity;
+    }
+    shared.items[shared.tail++ % shared.capacity] = t;
+    pthread_cond_signal(&shared.cond);
+    pthread_mutex_unlock(&shared.lock);
+}
+
+/* Returns NULL when all work is done */
+static struct task *shared_pop(void)
+{
+    struct task *t = NULL;
+
+    pthread_mutex_lock(&shared.lock);
+    while (shared.head == shared.tail && atomic_load(&pending) > 0)
+    {
+        pthread_cond_wait(&shared.cond, &shared.lock);
+    }
+    if (shared.head != shared.tail)
+    {
+        t = shared.items[shared.head++ % shared.capacity];
+    }
+    pthread_mutex_unlock(&shared.lock);
+
+    return t;
+}
+
+/*
+-----------------------------------------------------------------
+SUBMIT A NEW TASK FROM A WORKER
+-----------------------------------------------------------------
+*/
+static void submit(struct worker *w, struct task *t)
+{
+    if (t == NULL)
+    {
+        return;
+    }
+    atomic_fetch_add(&pending, 1);
+    if (use_stealing)
+    {
+        deque_push(&w->deque, t);
+    }
+    else
+    {
+        shared_push(t);
+    }
+}
+
+/*
+-----------------------------------------------------------------
+RUN ONE TASK
+-----------------------------------------------------------------
+FILE: open -> read -> process (newlines + hash) -> close
+DIR : push one task per entry
+*/
+static void run_task(struct worker *w, struct task *t)
+{
+    if (t->type == TASK_FILE)
+    {
+        static __thread char buf[READ_BUF];
+        unsigned long hash = 1469598103934665603UL;
+        ssize_t n;
+
+        int fd = open(t->path, O_RDONLY);
+        if (fd == -1)
+        {
+            return;
+        }
+        while ((n = read(fd, buf, sizeof(buf))) > 0)
+        {
+            for (ssize_t i = 0; i < n; i++)
+            {
+                hash = (hash ^ (unsigned char)buf[i]) * 1099511628211UL;
+            }
+            w->bytes += n;
+        }
+        close(fd);
+
+        w->files++;
+        w->checksum += hash;
+        return;
+    }
+
+    DIR *dir = opendir(t->path);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL)
+    {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0)
+        {
+            continue;
+        }
+
+        /* Some filesystems do not fill d_type */
+        unsigned char type = e->d_type;
+        if (type == DT_UNKNOWN)
+        {
+            struct stat st;
+            if (fstatat(dirfd(dir), e->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+            {
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : DT_UNKNOWN;
+            }
+        }
+
+        if (type == DT_DIR)
+        {
+            submit(w, task_new(TASK_DIR, t->path, e->d_name));
+        }
+        else if (type == DT_REG)
+        {
+            submit(w, task_new(TASK_FILE, t->path, e->d_name));
+        }
+    }
+    closedir(dir);
+}
+
+/*
+-----------------------------------------------------------------
+FIND WORK: OWN DEQUE FIRST, THEN STEAL FROM RANDOM VICTIMS
+-----------------------------------------------------------------
+*/
+static struct task *find_work(struct worker *w)
+{
+    struct task *t = deque_take(&w->deque);
+
+    while (t == NULL && atomic_load(&pending) > 0)
+    {
+        for (int tries = 0; tries < worker_count * 2 && t == NULL; tries++)
+        {
+            int victim = (int)(rand_r(&w->seed) % worker_count);
+
+            if (victim != w->id)
+            {
+                t = deque_steal(&workers[victim].deque);
+            }
+        }
+        if (t != NULL)
+        {
+            w->steals++;
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+
+    return t;
+}
+
+/*
+-----------------------------------------------------------------
+WORKER THREAD
+-----------------------------------------------------------------
+*/
+static void *worker_main(void *arg)
+{
+    struct worker *w = arg;
+
+    for (;;)
+    {
+        struct task *t = use_stealing ? find_work(w) : shared_pop();
+
+        if (t == NULL)
+        {
+            break;
+        }
+        run_task(w, t);
+        free(t);
+        w->tasks++;
+
+        if (atomic_fetch_sub(&pending, 1) == 1 && !use_stealing)
+        {
+            /* Last task done: wake everyone so they can exit */
+            pthread_mutex_lock(&shared.lock);
+            pthread_cond_broadcast(&shared.cond);
+            pthread_mutex_unlock(&shared.lock);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+RUN POOL ON A DIRECTORY TREE
+-----------------------------------------------------------------
+Returns elapsed milliseconds.
+*/
+static double run_pool(const char *root, int threads, int stealing)
+{
+    worker_count = threads;
+    use_stealing = stealing;
+    atomic_store(&pending, 1);
+
+    memset(&shared, 0, sizeof(shared));
+    pthread_mutex_init(&shared.lock, NULL);
+    pthread_cond_init(&shared.cond, NULL);
+
+    for (int i = 0; i < threads; i++)
+    {
+        memset(&workers[i], 0, sizeof(struct worker));
+        workers[i].id = i;
+        workers[i].seed = (unsigned int)(i * 2654435761u + 1);
+        deque_init(&workers[i].deque);
+    }
+
+    /* The root task goes to worker 0 (or the shared queue) */
+    struct task *root_task = task_new(TASK_DIR, root, NULL);
+    if (stealing)
+    {
+        deque_push(&workers[0].deque, root_task);
+    }
+    else
+    {
+        shared.items = malloc(DEQUE_INITIAL * sizeof(struct task *));
+        shared.capacity = DEQUE_INITIAL;
+        shared.items[shared.tail++] = root_task;
+    }
+
+    double start = now_ms();
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]);
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+    double elapsed = now_ms() - start;
+
+    for (int i = 0; i < threads; i++)
+    {
+        deque_destroy(&workers[i].deque);
+    }
+    free(shared.items);
+
+    return elapsed;
+}
+
+/*
+-----------------------------------------------------------------
+CREATE TEST TREE
+-----------------------------------------------------------------
+100 directories, file sizes 512 B .. 1 MB (mostly small).
+*/
+static int create_tree(const char *root, int files)
+{
+    static char block[1024 * 1024];
+    char path[4096];
+    unsigned int seed = 42;
+
+    memset(block, 'a', sizeof(block));
+    for (size_t i = 63; i < sizeof(block); i += 64)
+    {
+        block[i] = '\n';
+    }
+
+    if (mkdir(root, 0755) == -1)
+    {
+        return -1;
+    }
+    for (int d = 0; d < 100; d++)
+    {
+        snprintf(path, sizeof(path), "%s/d%02d", root, d);
+        mkdir(path, 0755);
+    }
+
+    for (int f = 0; f < files; f++)
+    {
+        /* Skewed sizes: 1 file in 64 is large */
+        int shift = rand_r(&seed) % 64 == 0 ? 11 : rand_r(&seed) % 4;
+        size_t size = (size_t)512 << shift;
+
+        snprintf(path, sizeof(path), "%s/d%02d/f%06d.txt", root, f % 100, f);
+        int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+        if (fd == -1 || write(fd, block, size) != (ssize_t)size)
+        {
+            return -1;
+        }
+        close(fd);
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares a work-stealing pool with a shared
+queue on a directory tree.
+*/
+int main(int argc, char *argv[])
+{
+    const char *root = argc > 1 ? argv[1] : "ws_data";
+    int files = argc > 2 ? atoi(argv[2]) : 20000;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = argc > 3 ? atoi(argv[3]) : (cores > 4 ? cores : 4);
+
+    if (max_threads <= 0 || max_threads > MAX_WORKERS)
+    {
+        max_threads = MAX_WORKERS;
+    }
+
+    /*
+    STEP 1: Test tree
+    -----------------
+    */
+    if (access(root, F_OK) == -1)
+    {
+        printf("Creating %s with %d files...\n", root, files);
+        if (create_tree(root, files) == -1)
+        {
+            perror("create tree failed");
+            return 1;
+        }
+    }
+
+    /*
+    STEP 2: Warm-up (fills page cache)
+    ----------------------------------
+    */
+    run_pool(root, 1, 1);
+    unsigned long ref_files = workers[0].files, ref_bytes = workers[0].bytes;
+    unsigned long ref_sum = workers[0].checksum;
+    printf("Tree %s: %lu files, %.1f MB\n\n", root, ref_files, ref_bytes / 1048576.0);
+
+    /*
+    STEP 3 + 4: Scaling table
+    -------------------------
+    */
+    printf("%7s %-8s %9s %10s %8s %8s %11s %11s\n", "threads", "mode", "ms", "files/s",
+           "MB/s", "steals", "min tasks", "max tasks");
+
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        for (int stealing = 0; stealing <= 1; stealing++)
+        {
+            double ms = run_pool(root, threads, stealing);
+            unsigned long nfiles = 0, sum = 0, steals = 0;
+            unsigned long min_tasks = (unsigned long)-1, max_tasks = 0;
+
+            for (int i = 0; i < threads; i++)
+            {
+                nfiles += workers[i].files;
+                sum += workers[i].checksum;
+                steals += workers[i].steals;
+                if (workers[i].tasks < min_tasks) min_tasks = workers[i].tasks;
+                if (workers[i].tasks > max_tasks) max_tasks = workers[i].tasks;
+            }
+            if (nfiles != ref_files || sum != ref_sum)
+            {
+                fprintf(stderr, "result mismatch (%lu files)\n", nfiles);
+                return 1;
+            }
+
+            printf("%7d %-8s %9.1f %10.0f %8.1f %8lu %11lu %11lu\n", threads,
+                   stealing ? "stealing" : "shared", ms, nfiles / (ms / 1e3),
+                   ref_bytes / 1048576.0 / (ms / 1e3), steals, min_tasks, max_tasks);
+        }
+    }
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. One deque per worker: owner uses the bottom, thieves the top
+2. Owner push/take need no lock; only the last item uses a CAS
+3. Thieves steal the OLDEST task (often a big subtree)
+4. Directory tasks create file tasks -> work spreads by stealing
+5. Atomic pending counter decides when the pool is finished
+6. Shared queue = one lock for all threads = contention
+7. Compare min / max tasks per worker to see load balance
+
+DEFINITION (IN SIMPLE WORDS):
+Every worker has its own to-do list. When a worker has
+nothing left to do, it quietly takes a job from the end
+of someone else's list.
+
+REAL-TIME EXAMPLES:
+- Intel TBB, Cilk, Go and Tokio schedulers
+- Java ForkJoinPool
+- Parallel file indexers and backup tools
+- Build systems scanning source trees
+
+=================================================================
+*/
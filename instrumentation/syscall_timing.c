@@ -0,0 +1,717 @@
+/*
+=================================================================
+SYSCALL TIMING INSTRUMENTATION – LD_PRELOAD LAYER (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How library calls are interposed with LD_PRELOAD
+2. How the real function is found with dlsym(RTLD_NEXT)
+3. How every call is timed with clock_gettime(CLOCK_MONOTONIC_RAW)
+4. How latencies go into log-linear histograms per thread
+5. How per-thread histograms are merged at exit
+6. How results are dumped as a table or as JSON
+
+DEFINITION:
+This is a shared library, not a program. When it is loaded
+with LD_PRELOAD, its open(), read(), write(), ... are found
+BEFORE the ones in libc. Each wrapper reads the clock, calls
+the real libc function, reads the clock again and counts the
+elapsed time in a histogram. Every demo in this repository
+can be measured this way without changing its source.
+
+SYNTAX (MAJOR CALLS USED):
+void *dlsym(void *handle, const char *symbol);
+int   clock_gettime(clockid_t clockid, struct timespec *tp);
+
+SYNTAX EXPLANATION:
+RTLD_NEXT            -> Find the NEXT definition of symbol
+                        (the real libc one, not ours)
+
+CLOCK_MONOTONIC_RAW  -> Hardware clock, not adjusted by NTP;
+                        read through the vDSO (no syscall)
+
+__attribute__((constructor / destructor))
+                     -> Run when the library is loaded / unloaded
+
+Log-linear histogram -> Power-of-two ranges, each split into
+                        8 linear sub-buckets (max 12.5% error),
+                        fixed size, no allocation per call
+
+INTERPOSED CALLS:
+open(), open64(), read(), write(), close(), readlink(),
+socket(), socketpair(), send(), recv(), fork(),
+execl(), execv(), execve(), execvp(), execlp()
+
+KEY POINTS:
+- Hot path: 2 clock reads + 3 increments, no locks
+- Each thread owns its histograms (thread-local pointer)
+- A thread block is registered once, under a mutex
+- Blocks are never freed, so exited threads still count
+- Merge + dump at exit (destructor)
+- exec() replaces the process: stats are dumped BEFORE it
+  and cleared (an exec row only appears when exec() fails)
+- fork() child starts with empty histograms
+- Dump uses the real write(), so it is not measured itself
+
+WHY AN LD_PRELOAD LAYER?
+- No change to the demo programs
+- Can stay enabled in production (low overhead)
+- Shows exactly where time goes per system call
+
+ENVIRONMENT VARIABLES:
+SYSCALL_TIMING_FORMAT=json   -> JSON output (default: table)
+SYSCALL_TIMING_FILE=path     -> Append output to file
+                                (default: stderr)
+
+WHAT THIS LIBRARY DOES (STEP BY STEP):
+
+STEP 1: Constructor looks up the real libc functions
+STEP 2: First call in a thread allocates its histogram block
+STEP 3: Each wrapper times the real call, adds to histogram
+STEP 4: At exit (or before exec) all blocks are merged
+STEP 5: Count, total, mean, p50, p90, p99, max are printed
+
+COMPILE:
+gcc -O2 -shared -fPIC syscall_timing.c -o libsyscall_timing.so -ldl
+LD_PRELOAD=./libsyscall_timing.so ../combined_flow/a.out
+
+EXPECTED OUTPUT (WHEN A DEMO IS RUN WITH IT):
+
+1. Normal output of the demo
+2. One table (or JSON object) per process with a row for
+   every system call that was used
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>      // For snprintf()
+#include <stdarg.h>     // For va_list (open(), execl())
+#include <stdlib.h>     // For getenv()
+#include <string.h>     // For strcmp(), memset()
+#include <dlfcn.h>      // For dlsym(), RTLD_NEXT
+#include <fcntl.h>      // For O_CREAT, O_TMPFILE
+#include <pthread.h>    // For pthread_mutex_t
+#include <time.h>       // For clock_gettime()
+#include <unistd.h>     // For read(), write(), fork(), getpid()
+#include <sys/mman.h>   // For mmap()
+#include <sys/socket.h> // For socket(), send(), recv()
+#include <sys/types.h>  // For ssize_t, pid_t
+
+enum call_id
+{
+    C_OPEN, C_READ, C_WRITE, C_CLOSE, C_READLINK, C_SOCKET,
+    C_SOCKETPAIR, C_SEND, C_RECV, C_FORK, C_EXEC, C_COUNT
+};
+
+static const char *call_names[C_COUNT] =
+{
+    "open", "read", "write", "close", "readlink", "socket",
+    "socketpair", "send", "recv", "fork", "exec"
+};
+
+#define SUB_BITS    3
+#define SUB_COUNT   (1 << SUB_BITS)
+#define BUCKETS     ((64 - SUB_BITS + 1) * SUB_COUNT)
+
+/*
+Histogram of one call in one thread.
+*/
+struct histogram
+{
+    unsigned long long count;
+    unsigned long long total_ns;
+    unsigned long long max_ns;
+    unsigned int       buckets[BUCKETS];
+};
+
+/*
+All histograms of one thread, linked into a global list.
+*/
+struct thread_block
+{
+    struct histogram     hist[C_COUNT];
+    struct thread_block *next;
+};
+
+static __thread struct thread_block *my_block;
+static struct thread_block *all_blocks;
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Real libc functions */
+static int     (*real_open)(const char *, int, ...);
+static int     (*real_open64)(const char *, int, ...);
+static ssize_t (*real_read)(int, void *, size_t);
+static ssize_t (*real_write)(int, const void *, size_t);
+static int     (*real_close)(int);
+static ssize_t (*real_readlink)(const char *, char *, size_t);
+static int     (*real_socket)(int, int, int);
+static int     (*real_socketpair)(int, int, int, int[2]);
+static ssize_t (*real_send)(int, const void *, size_t, int);
+static ssize_t (*real_recv)(int, void *, size_t, int);
+static pid_t   (*real_fork)(void);
+static int     (*real_execve)(const char *, char *const[], char *const[]);
+static int     (*real_execv)(const char *, char *const[]);
+static int     (*real_execvp)(const char *, char *const[]);
+
+#define RESOLVE(name) \
+    do { if (real_##name == NULL) real_##name = dlsym(RTLD_NEXT, #name); } while (0)
+
+/*
+-----------------------------------------------------------------
+CLOCK READ IN NANOSECONDS
+-----------------------------------------------------------------
+*/
+static inline unsigned long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+-----------------------------------------------------------------
+LOG-LINEAR BUCKET INDEX AND ITS BOUNDS
+-----------------------------------------------------------------
+Values below 8 get their own bucket. Above that, the power of
+two selects a range and the next 3 bits select a sub-bucket.
+*/
+static inline int bucket_of(unsigned long long v)
+{
+    if (v < SUB_COUNT)
+    {
+        return (int)v;
+    }
+    int exp = 63 - __builtin_clzll(v);
+    int sub = (int)((v >> (exp - SUB_BITS)) & (SUB_COUNT - 1));
+
+    return (exp - SUB_BITS + 1) * SUB_COUNT + sub;
+}
+
+static unsigned long long bucket_low(int b)
+{
+    if (b < SUB_COUNT)
+    {
+        return (unsigned long long)b;
+    }
+    int exp = b / SUB_COUNT + SUB_BITS - 1;
+    int sub = b % SUB_COUNT;
+
+    return (unsigned long long)(SUB_COUNT + sub) << (exp - SUB_BITS);
+}
+
+/* Highest value that still falls into bucket b */
+static unsigned long long bucket_high(int b)
+{
+    if (b + 1 >= BUCKETS)
+    {
+        return ~0ULL;
+    }
+    return bucket_low(b + 1) - 1;
+}
+
+/*
+-----------------------------------------------------------------
+GET (OR CREATE) THIS THREAD'S BLOCK
+-----------------------------------------------------------------
+mmap() is used instead of malloc() so that the allocator is
+never entered from inside an interposed call.
+*/
+static struct thread_block *thread_block(void)
+{
+    if (my_block != NULL)
+    {
+        return my_block;
+    }
+
+    struct thread_block *b = mmap(NULL, sizeof(*b), PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (b == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&blocks_lock);
+    b->next = all_blocks;
+    all_blocks = b;
+    pthread_mutex_unlock(&blocks_lock);
+
+    my_block = b;
+    return b;
+}
+
+/*
+-----------------------------------------------------------------
+RECORD ONE CALL (HOT PATH)
+-----------------------------------------------------------------
+*/
+static inline void record(int call, unsigned long long start)
+{
+    unsigned long long ns = now_ns() - start;
+    struct thread_block *b = thread_block();
+
+    if (b == NULL)
+    {
+        return;
+    }
+
+    struct histogram *h = &b->hist[call];
+    h->count++;
+    h->total_ns += ns;
+    h->buckets[bucket_of(ns)]++;
+    if (ns > h->max_ns)
+    {
+        h->max_ns = ns;
+    }
+}
+
+/*
+-----------------------------------------------------------------
+PERCENTILE FROM A MERGED HISTOGRAM
+-----------------------------------------------------------------
+Reports the highest value of the bucket (never below the true
+value), clamped to the largest sample seen.
+*/
+static unsigned long long percentile(const struct histogram *h, double p)
+{
+    unsigned long long target = (unsigned long long)(h->count * p);
+    unsigned long long seen = 0;
+
+    for (int b = 0; b < BUCKETS; b++)
+    {
+        seen += h->buckets[b];
+        if (seen > target)
+        {
+            unsigned long long high = bucket_high(b);
+            return high < h->max_ns ? high : h->max_ns;
+        }
+    }
+
+    return h->max_ns;
+}
+
+/*
+-----------------------------------------------------------------
+WRITE STRING WITH THE REAL write()
+-----------------------------------------------------------------
+*/
+static void out_str(int fd, const char *s)
+{
+    size_t len = strlen(s);
+
+    while (len > 0)
+    {
+        ssize_t n = real_write(fd, s, len);
+
+        if (n <= 0)
+        {
+            return;
+        }
+        s += n;
+        len -= n;
+    }
+}
+
+/*
+-----------------------------------------------------------------
+MERGE ALL THREADS AND DUMP
+-----------------------------------------------------------------
+*/
+static void dump_stats(const char *reason)
+{
+    static struct histogram merged[C_COUNT];
+    const char *format = getenv("SYSCALL_TIMING_FORMAT");
+    const char *file = getenv("SYSCALL_TIMING_FILE");
+    int json = format != NULL && strcmp(format, "json") == 0;
+    int fd = STDERR_FILENO;
+    char line[512];
+
+    RESOLVE(write);
+    RESOLVE(open);
+    RESOLVE(close);
+
+    memset(merged, 0, sizeof(merged));
+    pthread_mutex_lock(&blocks_lock);
+    for (struct thread_block *b = all_blocks; b != NULL; b = b->next)
+    {
+        for (int c = 0; c < C_COUNT; c++)
+        {
+            merged[c].count += b->hist[c].count;
+            merged[c].total_ns += b->hist[c].total_ns;
+            if (b->hist[c].max_ns > merged[c].max_ns)
+            {
+                merged[c].max_ns = b->hist[c].max_ns;
+            }
+            for (int k = 0; k < BUCKETS; k++)
+            {
+                merged[c].buckets[k] += b->hist[c].buckets[k];
+            }
+        }
+    }
+    pthread_mutex_unlock(&blocks_lock);
+
+    if (file != NULL)
+    {
+        fd = real_open(file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd == -1)
+        {
+            fd = STDERR_FILENO;
+        }
+    }
+
+    if (json)
+    {
+        snprintf(line, sizeof(line), "{\"pid\":%d,\"reason\":\"%s\",\"syscalls\":{", getpid(), reason);
+    }
+    else
+    {
+        snprintf(line, sizeof(line),
+                 "\n[syscall_timing pid %d, %s]\n%-11s %9s %12s %10s %10s %10s %10s %10s\n",
+                 getpid(), reason, "call", "count", "total_us", "mean_ns",
+                 "p50_ns", "p90_ns", "p99_ns", "max_ns");
+    }
+    out_str(fd, line);
+
+    int first = 1;
+    for (int c = 0; c < C_COUNT; c++)
+    {
+        const struct histogram *h = &merged[c];
+
+        if (h->count == 0)
+        {
+            continue;
+        }
+
+        unsigned long long mean = h->total_ns / h->count;
+        unsigned long long p50 = percentile(h, 0.50);
+        unsigned long long p90 = percentile(h, 0.90);
+        unsigned long long p99 = percentile(h, 0.99);
+
+        if (json)
+        {
+            snprintf(line, sizeof(line),
+                     "%s\"%s\":{\"count\":%llu,\"total_ns\":%llu,\"mean_ns\":%llu,"
+                     "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu}",
+                     first ? "" : ",", call_names[c], h->count, h->total_ns, mean,
+                     p50, p90, p99, h->max_ns);
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "%-11s %9llu %12.1f %10llu %10llu %10llu %10llu %10llu\n",
+                     call_names[c], h->count, h->total_ns / 1e3, mean, p50, p90, p99, h->max_ns);
+        }
+        out_str(fd, line);
+        first = 0;
+    }
+
+    if (json)
+    {
+        out_str(fd, "}}\n");
+    }
+    if (fd != STDERR_FILENO)
+    {
+        real_close(fd);
+    }
+}
+
+/*
+-----------------------------------------------------------------
+CLEAR ALL THREADS' HISTOGRAMS
+-----------------------------------------------------------------
+Used after the pre-exec dump: if exec() fails, the exit dump
+then shows only calls made since.
+*/
+static void reset_stats(void)
+{
+    pthread_mutex_lock(&blocks_lock);
+    for (struct thread_block *b = all_blocks; b != NULL; b = b->next)
+    {
+        memset(b->hist, 0, sizeof(b->hist));
+    }
+    pthread_mutex_unlock(&blocks_lock);
+}
+
+/*
+-----------------------------------------------------------------
+LIBRARY CONSTRUCTOR / DESTRUCTOR
+-----------------------------------------------------------------
+*/
+__attribute__((constructor))
+static void timing_init(void)
+{
+    RESOLVE(open);
+    RESOLVE(open64);
+    RESOLVE(read);
+    RESOLVE(write);
+    RESOLVE(close);
+    RESOLVE(readlink);
+    RESOLVE(socket);
+    RESOLVE(socketpair);
+    RESOLVE(send);
+    RESOLVE(recv);
+    RESOLVE(fork);
+    RESOLVE(execve);
+    RESOLVE(execv);
+    RESOLVE(execvp);
+}
+
+__attribute__((destructor))
+static void timing_fini(void)
+{
+    dump_stats("exit");
+}
+
+/*
+-----------------------------------------------------------------
+INTERPOSED FILE CALLS
+-----------------------------------------------------------------
+open() is variadic: mode is only passed with O_CREAT / O_TMPFILE.
+*/
+static int open_common(int (*fn)(const char *, int, ...), const char *path, int flags, mode_t mode)
+{
+    unsigned long long start = now_ns();
+    int fd = fn(path, flags, mode);
+
+    record(C_OPEN, start);
+    return fd;
+}
+
+int open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    if (flags & (O_CREAT | O_TMPFILE))
+    {
+        va_list ap;
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+    RESOLVE(open);
+    return open_common(real_open, path, flags, mode);
+}
+
+int open64(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    if (flags & (O_CREAT | O_TMPFILE))
+    {
+        va_list ap;
+        va_start(ap, flags);
+        mode = va_arg(ap, mode_t);
+        va_end(ap);
+    }
+    RESOLVE(open64);
+    return open_common(real_open64, path, flags, mode);
+}
+
+ssize_t read(int fd, void *buf, size_t count)
+{
+    RESOLVE(read);
+    unsigned long long start = now_ns();
+    ssize_t n = real_read(fd, buf, count);
+    record(C_READ, start);
+    return n;
+}
+
+ssize_t write(int fd, const void *buf, size_t count)
+{
+    RESOLVE(write);
+    unsigned long long start = now_ns();
+    ssize_t n = real_write(fd, buf, count);
+    record(C_WRITE, start);
+    return n;
+}
+
+int close(int fd)
+{
+    RESOLVE(close);
+    unsigned long long start = now_ns();
+    int rc = real_close(fd);
+    record(C_CLOSE, start);
+    return rc;
+}
+
+ssize_t readlink(const char *path, char *buf, size_t size)
+{
+    RESOLVE(readlink);
+    unsigned long long start = now_ns();
+    ssize_t n = real_readlink(path, buf, size);
+    record(C_READLINK, start);
+    return n;
+}
+
+/*
+-----------------------------------------------------------------
+INTERPOSED SOCKET CALLS
+-----------------------------------------------------------------
+*/
+int socket(int domain, int type, int protocol)
+{
+    RESOLVE(socket);
+    unsigned long long start = now_ns();
+    int fd = real_socket(domain, type, protocol);
+    record(C_SOCKET, start);
+    return fd;
+}
+
+int socketpair(int domain, int type, int protocol, int sv[2])
+{
+    RESOLVE(socketpair);
+    unsigned long long start = now_ns();
+    int rc = real_socketpair(domain, type, protocol, sv);
+    record(C_SOCKETPAIR, start);
+    return rc;
+}
+
+ssize_t send(int fd, const void *buf, size_t len, int flags)
+{
+    RESOLVE(send);
+    unsigned long long start = now_ns();
+    ssize_t n = real_send(fd, buf, len, flags);
+    record(C_SEND, start);
+    return n;
+}
+
+ssize_t recv(int fd, void *buf, size_t len, int flags)
+{
+    RESOLVE(recv);
+    unsigned long long start = now_ns();
+    ssize_t n = real_recv(fd, buf, len, flags);
+    record(C_RECV, start);
+    return n;
+}
+
+/*
+-----------------------------------------------------------------
+INTERPOSED PROCESS CALLS
+-----------------------------------------------------------------
+fork(): the child clears the copied histograms so each process
+reports only its own calls.
+exec(): on success nothing returns, so stats are dumped first
+and then cleared; a failed exec() is recorded with its latency
+and reported by the exit dump.
+*/
+pid_t fork(void)
+{
+    RESOLVE(fork);
+    unsigned long long start = now_ns();
+    pid_t pid = real_fork();
+
+    if (pid == 0)
+    {
+        for (struct thread_block *b = all_blocks; b != NULL; b = b->next)
+        {
+            memset(b->hist, 0, sizeof(b->hist));
+        }
+        pthread_mutex_init(&blocks_lock, NULL);
+        return 0;
+    }
+
+    record(C_FORK, start);
+    return pid;
+}
+
+int execve(const char *path, char *const argv[], char *const envp[])
+{
+    RESOLVE(execve);
+    dump_stats("exec");
+    reset_stats();
+    unsigned long long start = now_ns();
+    int rc = real_execve(path, argv, envp);
+    record(C_EXEC, start);
+    return rc;
+}
+
+int execv(const char *path, char *const argv[])
+{
+    RESOLVE(execv);
+    dump_stats("exec");
+    reset_stats();
+    unsigned long long start = now_ns();
+    int rc = real_execv(path, argv);
+    record(C_EXEC, start);
+    return rc;
+}
+
+int execvp(const char *file, char *const argv[])
+{
+    RESOLVE(execvp);
+    dump_stats("exec");
+    reset_stats();
+    unsigned long long start = now_ns();
+    int rc = real_execvp(file, argv);
+    record(C_EXEC, start);
+    return rc;
+}
+
+/*
+execl() / execlp() collect their variadic arguments into an
+argv array and go through the wrappers above.
+*/
+#define MAX_EXEC_ARGS 256
+
+int execl(const char *path, const char *arg, ...)
+{
+    char *argv[MAX_EXEC_ARGS];
+    int argc = 0;
+    va_list ap;
+
+    argv[argc++] = (char *)arg;
+    va_start(ap, arg);
+    while (argc < MAX_EXEC_ARGS - 1 && (argv[argc] = va_arg(ap, char *)) != NULL)
+    {
+        argc++;
+    }
+    va_end(ap);
+    argv[argc] = NULL;
+
+    return execv(path, argv);
+}
+
+int execlp(const char *file, const char *arg, ...)
+{
+    char *argv[MAX_EXEC_ARGS];
+    int argc = 0;
+    va_list ap;
+
+    argv[argc++] = (char *)arg;
+    va_start(ap, arg);
+    while (argc < MAX_EXEC_ARGS - 1 && (argv[argc] = va_arg(ap, char *)) != NULL)
+    {
+        argc++;
+    }
+    va_end(ap);
+    argv[argc] = NULL;
+
+    return execvp(file, argv);
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. LD_PRELOAD loads our library before libc
+2. Our open()/read()/... wrap the real ones from dlsym(RTLD_NEXT)
+3. CLOCK_MONOTONIC_RAW is read via vDSO: no extra syscall
+4. Log-linear histogram = fixed memory, ~12.5% bucket error
+5. Per-thread blocks: no locks on the hot path
+6. Merge at exit (destructor), dump before exec()
+7. fork() child resets histograms
+
+DEFINITION (IN SIMPLE WORDS):
+A small library slips in between the program and
+libc, starts a stopwatch around every system call,
+and prints a summary when the program ends.
+
+REAL-TIME EXAMPLES:
+- strace -c / ltrace (slower, ptrace based)
+- Production latency profiling
+- Allocation / I/O interposers (jemalloc, libfaketime)
+- Performance regression triage
+
+=================================================================
+*/
@@ -0,0 +1,788 @@
+/*
+=================================================================
+OPEN-LOOP LOAD GENERATOR – TIMERFD / EPOLL (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to send requests at a FIXED RATE with timerfd
+   (open loop), not "next request after the last reply"
+2. How to measure latency from the INTENDED send time
+   (coordinated-omission-correct)
+3. HDR-style log-linear histograms, one per thread, merged
+4. Many connections spread over several threads
+5. What a closed-loop tester reports when the server stalls
+
+DEFINITION:
+Coordinated omission: a closed-loop tester waits for each
+reply before sending the next request. When the server
+stalls, the tester stops sending too, so the stall shows up
+in ONE sample per connection instead of in every request
+that should have been sent during it. The tail looks great
+and is wrong.
+
+An open-loop generator keeps a schedule: request k is due
+at start + k * interval. Latency = reply time - due time,
+no matter when the request actually left the client.
+
+SYNTAX (MAJOR CALLS USED):
+int timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+int timerfd_settime(int fd, 0, &its, NULL);
+int epoll_create1(0);
+int epoll_wait(int epfd, struct epoll_event *ev, int n, int ms);
+ssize_t send(int fd, const void *buf, size_t len, MSG_DONTWAIT);
+
+SYNTAX EXPLANATION:
+timerfd        -> Periodic tick delivered as a readable fd
+read(timerfd)  -> Number of expirations since last read
+intended time  -> start + k * interval (the schedule)
+corrected      -> reply time - intended time
+closed loop    -> one request in flight per connection;
+                  due requests on a busy connection are
+                  skipped, latency measured from real send
+
+KEY POINTS:
+- One epoll loop per thread: timerfd + its connections
+- On every tick, send ALL requests that are due by now
+- Replies come back in order per connection, so a FIFO
+  of intended times per connection is enough
+- Unsent bytes are queued; the schedule never waits
+- "send lag" = how late the generator itself was; if it
+  grows, the generator is the bottleneck, not the server
+- Default: a built-in echo server (forked) that stalls
+  once for -S ms in the middle of the run
+
+WHY OPEN LOOP?
+- Real users do not wait for other users' replies
+- Closed-loop testers hide stalls (coordinated omission)
+- A fixed rate shows latency at a KNOWN load level
+
+IMPORTANT APIs:
+timerfd_create(), timerfd_settime() -> Rate clock
+epoll_create1(), epoll_ctl(), epoll_wait() -> Event loop
+socket(), connect(), send(), recv() -> Traffic
+pthread_create()  -> Connection threads
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Parses rate, connections, threads, duration
+STEP 2: Starts the built-in echo server unless -p is given
+STEP 3: Each thread connects its share of connections
+STEP 4: Each thread sends on timerfd ticks and records
+        latency into its own histograms
+STEP 5: After the run, waits for replies still in flight
+STEP 6: Merges histograms and prints percentiles for the
+        closed-loop and open-loop runs
+
+COMPILE:
+gcc -O2 -pthread load_generator.c
+./a.out [-r rate] [-c conns] [-t threads] [-d seconds]
+        [-s size] [-S stall_ms] [-m open|closed|both]
+        [-H host -p port]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Closed loop: p99 stays low, requests are "missing"
+2. Open loop: p99 / p99.9 show the server stall
+3. Both runs report achieved rate and send lag
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>          // For printf(), perror()
+#include <stdlib.h>         // For atoi(), atof(), calloc()
+#include <string.h>         // For memset(), strcmp()
+#include <errno.h>          // For errno, EAGAIN
+#include <fcntl.h>          // For fcntl(), O_NONBLOCK
+#include <getopt.h>         // For getopt()
+#include <pthread.h>        // For pthread_create()
+#include <signal.h>         // For kill(), SIGTERM
+#include <time.h>           // For clock_gettime()
+#include <unistd.h>         // For fork(), read(), close()
+#include <arpa/inet.h>      // For inet_pton(), htons()
+#include <netinet/in.h>     // For struct sockaddr_in
+#include <netinet/tcp.h>    // For TCP_NODELAY
+#include <sys/epoll.h>      // For epoll_create1(), epoll_wait()
+#include <sys/socket.h>     // For socket(), send(), recv()
+#include <sys/timerfd.h>    // For timerfd_create(), timerfd_settime()
+#include <sys/wait.h>       // For waitpid()
+
+#define SUB_BITS          7           /* 128 sub-buckets: < 1% error */
+#define SUB_COUNT         (1 << SUB_BITS)
+#define BUCKETS           ((64 - SUB_BITS + 1) * SUB_COUNT)
+#define RING              16384       /* in-flight requests per connection */
+#define MIN_TICK_NS       20000UL
+#define DRAIN_NS          2000000000UL
+#define MAX_EVENTS        64
+
+enum mode { MODE_CLOSED, MODE_OPEN };
+
+/*
+Log-linear latency histogram (HDR-style).
+*/
+struct histogram
+{
+    unsigned long count;
+    unsigned long max_ns;
+    unsigned int  buckets[BUCKETS];
+};
+
+/*
+One connection: FIFO of in-flight requests.
+*/
+struct conn
+{
+    int            fd;
+    unsigned long  unsent;          /* bytes queued behind EAGAIN */
+    unsigned long  got;             /* bytes of the current reply */
+    unsigned long *due;             /* intended (or real) send times */
+    unsigned       head, tail;
+    int            want_out;
+};
+
+/*
+One generator thread and its share of the schedule.
+*/
+struct worker
+{
+    pthread_t         thread;
+    int               nconn;
+    struct conn      *conns;
+    unsigned long     interval_ns;
+    unsigned long     start_ns, end_ns;
+    enum mode         mode;
+    int               size;
+    struct histogram  hist;
+    unsigned long     scheduled, sent, completed, skipped, overflow, errors;
+    unsigned long     max_lag_ns;
+};
+
+static struct sockaddr_in target;
+static char tx_buf[65536];
+
+/*
+-----------------------------------------------------------------
+CLOCK IN NANOSECONDS
+-----------------------------------------------------------------
+*/
+static inline unsigned long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+/*
+-----------------------------------------------------------------
+HISTOGRAM HELPERS (LOG-LINEAR, 128 SUB-BUCKETS)
+-----------------------------------------------------------------
+*/
+static inline void hist_add(struct histogram *h, unsigned long v)
+{
+    int b;
+
+    if (v < SUB_COUNT)
+    {
+        b = (int)v;
+    }
+    else
+    {
+        int exp = 63 - __builtin_clzl(v);
+        b = (exp - SUB_BITS + 1) * SUB_COUNT + (int)((v >> (exp - SUB_BITS)) & (SUB_COUNT - 1));
+    }
+    h->buckets[b]++;
+    h->count++;
+    if (v > h->max_ns)
+    {
+        h->max_ns = v;
+    }
+}
+
+static unsigned long bucket_low(int b)
+{
+    if (b < SUB_COUNT)
+    {
+        return (unsigned long)b;
+    }
+    int exp = b / SUB_COUNT + SUB_BITS - 1;
+    return (unsigned long)(SUB_COUNT + b % SUB_COUNT) << (exp - SUB_BITS);
+}
+
+/* Highest value that still falls into bucket b */
+static unsigned long bucket_high(int b)
+{
+    if (b + 1 >= BUCKETS)
+    {
+        return ~0UL;
+    }
+    return bucket_low(b + 1) - 1;
+}
+
+/*
+Reports the highest value of the bucket (never below the true
+value), clamped to the largest sample seen.
+*/
+static unsigned long hist_percentile(const struct histogram *h, double p)
+{
+    unsigned long target = (unsigned long)(h->count * p), seen = 0;
+
+    for (int b = 0; b < BUCKETS; b++)
+    {
+        seen += h->buckets[b];
+        if (seen > target)
+        {
+            unsigned long high = bucket_high(b);
+            return high < h->max_ns ? high : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+static void hist_merge(struct histogram *dst, const struct histogram *src)
+{
+    dst->count += src->count;
+    if (src->max_ns > dst->max_ns)
+    {
+        dst->max_ns = src->max_ns;
+    }
+    for (int b = 0; b < BUCKETS; b++)
+    {
+        dst->buckets[b] += src->buckets[b];
+    }
+}
+
+/*
+-----------------------------------------------------------------
+BUILT-IN ECHO SERVER (CHILD PROCESS)
+-----------------------------------------------------------------
+Single-threaded epoll echo. Stalls ONCE for stall_ms,
+stall_at_ms after the first connection arrives.
+*/
+static void echo_server(int listen_fd, int stall_ms, int stall_at_ms)
+{
+    struct epoll_event ev, events[MAX_EVENTS];
+    char buf[65536];
+    unsigned long first = 0;
+    int stalled = stall_ms <= 0;
+
+    int epfd = epoll_create1(0);
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+
+    for (;;)
+    {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+
+        if (!stalled && first && now_ns() - first >= stall_at_ms * 1000000UL)
+        {
+            usleep(stall_ms * 1000);    /* GC pause, disk hiccup ... */
+            stalled = 1;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == listen_fd)
+            {
+                int c = accept(listen_fd, NULL, NULL);
+                int one = 1;
+                if (c == -1)
+                {
+                    continue;
+                }
+                setsockopt(c, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                ev.events = EPOLLIN;
+                ev.data.fd = c;
+                epoll_ctl(epfd, EPOLL_CTL_ADD, c, &ev);
+                if (!first)
+                {
+                    first = now_ns();
+                }
+                continue;
+            }
+
+            ssize_t r = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (r <= 0)
+            {
+                if (r == 0 || errno != EAGAIN)
+                {
+                    close(fd);
+                }
+                continue;
+            }
+
+            /* Blocking echo: the client always reads */
+            for (ssize_t off = 0; off < r;)
+            {
+                ssize_t w = send(fd, buf + off, r - off, MSG_NOSIGNAL);
+                if (w <= 0)
+                {
+                    break;
+                }
+                off += w;
+            }
+        }
+    }
+}
+
+/*
+-----------------------------------------------------------------
+SEND QUEUED BYTES OF ONE CONNECTION
+-----------------------------------------------------------------
+*/
+static int conn_flush(struct conn *c)
+{
+    while (c->unsent > 0)
+    {
+        size_t len = c->unsent < sizeof(tx_buf) ? c->unsent : sizeof(tx_buf);
+        ssize_t w = send(c->fd, tx_buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if (w == -1)
+        {
+            return errno == EAGAIN ? 0 : -1;
+        }
+        c->unsent -= w;
+    }
+    return 0;
+}
+
+static void conn_want_out(int epfd, struct conn *c, int want)
+{
+    struct epoll_event ev;
+
+    if (c->want_out == want)
+    {
+        return;
+    }
+    c->want_out = want;
+    ev.events = EPOLLIN | (want ? EPOLLOUT : 0);
+    ev.data.ptr = c;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+/*
+-----------------------------------------------------------------
+ISSUE REQUESTS THAT ARE DUE
+-----------------------------------------------------------------
+Request k of this thread is due at start + k * interval.
+*/
+static void send_due(struct worker *w, int epfd, unsigned long now, int *rr)
+{
+    while (w->start_ns + w->scheduled * w->interval_ns <= now &&
+           w->start_ns + w->scheduled * w->interval_ns < w->end_ns)
+    {
+        unsigned long due = w->start_ns + w->scheduled * w->interval_ns;
+        struct conn *c = &w->conns[*rr];
+
+        *rr = (*rr + 1) % w->nconn;
+        w->scheduled++;
+
+        if (w->mode == MODE_CLOSED && c->head != c->tail)
+        {
+            w->skipped++;       /* busy: a closed-loop tester waits */
+            continue;
+        }
+        if (c->tail - c->head == RING)
+        {
+            w->overflow++;
+            continue;
+        }
+        if (now - due > w->max_lag_ns)
+        {
+            w->max_lag_ns = now - due;
+        }
+
+        /* Closed loop measures from the real send time */
+        c->due[c->tail++ % RING] = w->mode == MODE_OPEN ? due : now;
+        c->unsent += w->size;
+        w->sent++;
+        if (conn_flush(c) == -1)
+        {
+            w->errors++;
+        }
+        conn_want_out(epfd, c, c->unsent > 0);
+    }
+}
+
+/*
+-----------------------------------------------------------------
+GENERATOR THREAD
+-----------------------------------------------------------------
+*/
+static void *worker_main(void *arg)
+{
+    struct worker *w = arg;
+    struct epoll_event ev, events[MAX_EVENTS];
+    struct itimerspec its;
+    char buf[65536];
+    int rr = 0;
+    unsigned long in_flight = 0;
+
+    int epfd = epoll_create1(0);
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (epfd == -1 || tfd == -1)
+    {
+        perror("epoll/timerfd failed");
+        return NULL;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;            /* NULL = the timer */
+    epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, &ev);
+    for (int i = 0; i < w->nconn; i++)
+    {
+        ev.events = EPOLLIN;
+        ev.data.ptr = &w->conns[i];
+        epoll_ctl(epfd, EPOLL_CTL_ADD, w->conns[i].fd, &ev);
+    }
+
+    unsigned long tick = w->interval_ns > MIN_TICK_NS ? w->interval_ns : MIN_TICK_NS;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = w->start_ns / 1000000000UL;
+    its.it_value.tv_nsec = w->start_ns % 1000000000UL;
+    its.it_interval.tv_sec = tick / 1000000000UL;
+    its.it_interval.tv_nsec = tick % 1000000000UL;
+    timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL);
+
+    for (;;)
+    {
+        unsigned long now = now_ns();
+
+        in_flight = w->sent - w->completed;
+        if (now >= w->end_ns && (in_flight == 0 || now >= w->end_ns + DRAIN_NS))
+        {
+            break;
+        }
+
+        int n = epoll_wait(epfd, events, MAX_EVENTS, 100);
+        if (n == -1 && errno != EINTR)
+        {
+            perror("epoll_wait failed");
+            break;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            struct conn *c = events[i].data.ptr;
+
+            if (c == NULL)
+            {
+                unsigned long expirations;
+                if (read(tfd, &expirations, sizeof(expirations)) > 0)
+                {
+                    send_due(w, epfd, now_ns(), &rr);
+                }
+                continue;
+            }
+
+            if (events[i].events & EPOLLOUT)
+            {
+                if (conn_flush(c) == -1)
+                {
+                    w->errors++;
+                }
+                conn_want_out(epfd, c, c->unsent > 0);
+            }
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                ssize_t r = recv(c->fd, buf, sizeof(buf), MSG_DONTWAIT);
+                if (r <= 0)
+                {
+                    if (r == 0 || errno != EAGAIN)
+                    {
+                        w->errors++;
+                        epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+                    }
+                    continue;
+                }
+
+                unsigned long t = now_ns();
+                c->got += r;
+                while (c->got >= (unsigned long)w->size && c->head != c->tail)
+                {
+                    c->got -= w->size;
+                    hist_add(&w->hist, t - c->due[c->head++ % RING]);
+                    w->completed++;
+                }
+
+                /* Closed loop: the reply frees the connection now */
+                if (w->mode == MODE_CLOSED)
+                {
+                    send_due(w, epfd, t, &rr);
+                }
+            }
+        }
+    }
+
+    close(tfd);
+    close(epfd);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+ONE RUN: CONNECT, GENERATE, MERGE, PRINT
+-----------------------------------------------------------------
+*/
+static int run(enum mode mode, double rate, int nconn, int nthreads, double seconds, int size)
+{
+    struct worker *workers = calloc(nthreads, sizeof(*workers));
+    static struct histogram all;
+    unsigned long sched = 0, sent = 0, done = 0, skipped = 0, overflow = 0, errors = 0;
+    unsigned long lag = 0;
+
+    if (workers == NULL)
+    {
+        perror("calloc failed");
+        return -1;
+    }
+
+    /*
+    STEP 3: Connect every thread's share of connections
+    ---------------------------------------------------
+    */
+    unsigned long start = now_ns() + 200000000UL;      /* common start */
+    for (int t = 0; t < nthreads; t++)
+    {
+        struct worker *w = &workers[t];
+
+        w->nconn = nconn / nthreads + (t < nconn % nthreads);
+        w->conns = calloc(w->nconn, sizeof(*w->conns));
+        w->interval_ns = (unsigned long)(1e9 * nthreads / rate);
+        w->start_ns = start + t * (w->interval_ns / nthreads);
+        w->end_ns = start + (unsigned long)(seconds * 1e9);
+        w->mode = mode;
+        w->size = size;
+        if (w->conns == NULL)
+        {
+            perror("calloc failed");
+            return -1;
+        }
+
+        for (int i = 0; i < w->nconn; i++)
+        {
+            struct conn *c = &w->conns[i];
+            int one = 1;
+
+            c->due = malloc(RING * sizeof(*c->due));
+            c->fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (c->due == NULL || c->fd == -1 ||
+                connect(c->fd, (struct sockaddr *)&target, sizeof(target)) == -1)
+            {
+                perror("connect failed");
+                return -1;
+            }
+            setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fcntl(c->fd, F_SETFL, fcntl(c->fd, F_GETFL) | O_NONBLOCK);
+        }
+    }
+
+    /*
+    STEP 4 + 5: Generate load, then drain in-flight replies
+    -------------------------------------------------------
+    */
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0)
+        {
+            perror("pthread_create failed");
+            return -1;
+        }
+    }
+
+    memset(&all, 0, sizeof(all));
+    for (int t = 0; t < nthreads; t++)
+    {
+        struct worker *w = &workers[t];
+
+        pthread_join(w->thread, NULL);
+        hist_merge(&all, &w->hist);
+        sched += w->scheduled;
+        sent += w->sent;
+        done += w->completed;
+        skipped += w->skipped;
+        overflow += w->overflow;
+        errors += w->errors;
+        if (w->max_lag_ns > lag)
+        {
+            lag = w->max_lag_ns;
+        }
+
+        for (int i = 0; i < w->nconn; i++)
+        {
+            close(w->conns[i].fd);
+            free(w->conns[i].due);
+        }
+        free(w->conns);
+    }
+    free(workers);
+
+    /*
+    STEP 6: Report
+    --------------
+    */
+    printf("\n%s loop: target %.0f req/s, achieved %.0f req/s\n",
+           mode == MODE_OPEN ? "OPEN" : "CLOSED", rate, done / seconds);
+    printf("  scheduled %lu  sent %lu  completed %lu  skipped %lu  overflow %lu  errors %lu\n",
+           sched, sent, done, skipped, overflow, errors);
+    printf("  max send lag %.1f us (generator lateness)\n", lag / 1e3);
+    printf("  %10s %10s %10s %10s %10s %10s  (us)\n",
+           "p50", "p90", "p99", "p99.9", "p99.99", "max");
+    printf("  %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+           hist_percentile(&all, 0.50) / 1e3, hist_percentile(&all, 0.90) / 1e3,
+           hist_percentile(&all, 0.99) / 1e3, hist_percentile(&all, 0.999) / 1e3,
+           hist_percentile(&all, 0.9999) / 1e3, all.max_ns / 1e3);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program is an open-loop TCP load generator.
+*/
+int main(int argc, char *argv[])
+{
+    double rate = 20000, seconds = 4;
+    int nconn = 16, nthreads = 2, size = 64, stall_ms = 200, port = 0, opt;
+    const char *host = "127.0.0.1", *mode_name = "both";
+
+    /*
+    STEP 1: Options
+    ---------------
+    */
+    while ((opt = getopt(argc, argv, "r:c:t:d:s:S:m:H:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': rate = atof(optarg); break;
+        case 'c': nconn = atoi(optarg); break;
+        case 't': nthreads = atoi(optarg); break;
+        case 'd': seconds = atof(optarg); break;
+        case 's': size = atoi(optarg); break;
+        case 'S': stall_ms = atoi(optarg); break;
+        case 'm': mode_name = optarg; break;
+        case 'H': host = optarg; break;
+        case 'p': port = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-r rate] [-c conns] [-t threads] [-d seconds] "
+                    "[-s size] [-S stall_ms] [-m open|closed|both] [-H host -p port]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (rate <= 0 || seconds <= 0 || nthreads < 1 || nconn < nthreads ||
+        size < 1 || size > (int)sizeof(tx_buf))
+    {
+        fprintf(stderr, "invalid options (need conns >= threads >= 1, 1 <= size <= 64K)\n");
+        return 1;
+    }
+
+    memset(tx_buf, 'x', sizeof(tx_buf));
+    memset(&target, 0, sizeof(target));
+    target.sin_family = AF_INET;
+    if (inet_pton(AF_INET, host, &target.sin_addr) != 1)
+    {
+        fprintf(stderr, "bad IPv4 address: %s\n", host);
+        return 1;
+    }
+
+    printf("rate %.0f req/s, %d connections, %d threads, %.1f s, %d-byte requests\n",
+           rate, nconn, nthreads, seconds, size);
+
+    for (enum mode mode = MODE_CLOSED; mode <= MODE_OPEN; mode++)
+    {
+        pid_t server = -1;
+
+        if ((mode == MODE_OPEN && strcmp(mode_name, "closed") == 0) ||
+            (mode == MODE_CLOSED && strcmp(mode_name, "open") == 0))
+        {
+            continue;
+        }
+
+        /*
+        STEP 2: Built-in echo server (fresh one per run)
+        ------------------------------------------------
+        */
+        if (port != 0)
+        {
+            target.sin_port = htons(port);
+        }
+        else
+        {
+            socklen_t len = sizeof(target);
+            int lfd = socket(AF_INET, SOCK_STREAM, 0);
+
+            target.sin_port = 0;
+            if (lfd == -1 || bind(lfd, (struct sockaddr *)&target, sizeof(target)) == -1 ||
+                listen(lfd, 128) == -1 ||
+                getsockname(lfd, (struct sockaddr *)&target, &len) == -1)
+            {
+                perror("echo server socket failed");
+                return 1;
+            }
+
+            server = fork();
+            if (server == -1)
+            {
+                perror("fork failed");
+                return 1;
+            }
+            if (server == 0)
+            {
+                echo_server(lfd, stall_ms, (int)(seconds * 500) + 200);
+                _exit(0);
+            }
+            close(lfd);
+            if (mode == MODE_CLOSED)
+            {
+                printf("built-in echo server stalls once for %d ms mid-run\n", stall_ms);
+            }
+        }
+
+        int rc = run(mode, rate, nconn, nthreads, seconds, size);
+
+        if (server > 0)
+        {
+            kill(server, SIGTERM);
+            waitpid(server, NULL, 0);
+        }
+        if (rc == -1)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Open loop: send on a schedule, never wait for replies
+2. Latency = reply time - INTENDED send time
+3. Closed loop hides stalls: coordinated omission
+4. timerfd gives the tick; send everything that is due
+5. Log-linear (HDR-style) histograms: fixed memory,
+   per-thread, merged at the end
+6. Watch send lag: a late generator is a broken benchmark
+7. Report p99 / p99.9 / max, not just the average
+
+DEFINITION (IN SIMPLE WORDS):
+Customers keep arriving at the shop even when the
+cashier freezes; the clock for each one starts when
+they walk in, not when the cashier finally looks up.
+
+REAL-TIME EXAMPLES:
+- wrk2, Gil Tene's HdrHistogram and "How NOT to Measure
+  Latency"
+- Load testing RPC / HTTP servers before release
+- Checking GC pauses or fsync stalls show up in SLOs
+- Capacity planning at a fixed request rate
+
+=================================================================
+*/
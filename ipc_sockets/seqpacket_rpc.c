@@ -0,0 +1,544 @@
+/*
+=================================================================
+PIPELINED RPC OVER SOCK_SEQPACKET – SOCKET / IPC (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. A tiny RPC layer on a SOCK_SEQPACKET socketpair()
+2. Request IDs so many requests can be in flight at once
+3. A child that answers OUT OF ORDER from a worker pool
+4. Batched responses: many answers in one packet
+5. Requests/sec at pipeline depths 1 .. 256
+
+DEFINITION:
+SOCK_SEQPACKET is a connected, reliable socket that keeps
+message boundaries: one send() is exactly one recv().
+That makes it a natural RPC transport – no framing code.
+
+Pipelining means the client does not wait for a reply
+before sending the next request. Each request carries an
+ID, so replies can come back in any order and in batches.
+
+SYNTAX (MAJOR CALLS USED):
+int socketpair(AF_UNIX, SOCK_SEQPACKET, 0, int sv[2]);
+ssize_t send(int fd, const void *buf, size_t len, int flags);
+ssize_t recv(int fd, void *buf, size_t len, int flags);
+int pthread_create(pthread_t *t, NULL, fn, arg);
+
+SYNTAX EXPLANATION:
+SOCK_SEQPACKET -> Reliable, ordered, message boundaries kept
+struct rpc_request  -> { id, op, arg } one per packet
+struct rpc_response -> { count, { id, result } x count }
+depth               -> Max requests in flight per connection
+
+KEY POINTS:
+- depth 1 = classic blocking send() then recv()
+- Request ID = (generation << 16) | slot
+  slot indexes the client's in-flight table
+- Child: 1 receiver thread -> work queue -> WORKERS
+  threads -> completion list -> 1 responder thread
+- Responder sends ALL ready completions in one packet
+  (up to RPC_BATCH) – fewer syscalls under load
+- Work per request varies, so replies overtake each other
+
+WHY PIPELINING?
+- A blocking RPC pays a full round trip per request
+- Workers sit idle while the client waits
+- In-flight requests hide latency and keep workers busy
+- Batching amortizes syscall and wakeup cost
+
+IMPORTANT APIs:
+socketpair()   -> Connected local sockets
+fork()         -> Client (parent) and server (child)
+send()/recv()  -> One packet = one message
+pthread_*      -> Worker pool, queues
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Creates a SOCK_SEQPACKET socketpair
+STEP 2: Forks; the child starts the RPC server threads
+STEP 3: The parent runs N requests at each depth
+        1, 2, 4 ... 256, verifying every result
+STEP 4: Prints req/s, responses per packet and how many
+        replies arrived out of order
+STEP 5: Closes its end; the server drains and exits
+
+COMPILE:
+gcc -O2 -pthread seqpacket_rpc.c
+./a.out [requests_per_depth] [workers]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. req/s rises with depth, then levels off
+2. Responses per packet grow with depth (batching)
+3. Out-of-order replies appear once depth > 1
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>          // For printf(), perror()
+#include <stddef.h>         // For offsetof()
+#include <stdlib.h>         // For atol(), atoi(), exit()
+#include <stdint.h>         // For uint32_t, uint64_t
+#include <string.h>         // For memset()
+#include <pthread.h>        // For pthread_create(), mutex, cond
+#include <time.h>           // For clock_gettime()
+#include <unistd.h>         // For fork(), close()
+#include <sys/socket.h>     // For socketpair(), send(), recv()
+#include <sys/wait.h>       // For waitpid()
+
+#define MAX_DEPTH       256
+#define RPC_BATCH       64
+#define QUEUE_SIZE      1024       /* > MAX_DEPTH, never fills */
+#define OP_HASH         1
+
+struct rpc_request
+{
+    uint32_t id;
+    uint32_t op;
+    uint64_t arg;
+};
+
+struct rpc_result
+{
+    uint32_t id;
+    uint32_t pad;
+    uint64_t result;
+};
+
+struct rpc_response
+{
+    uint32_t count;
+    uint32_t pad;
+    struct rpc_result results[RPC_BATCH];
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN SECONDS
+-----------------------------------------------------------------
+*/
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+-----------------------------------------------------------------
+THE REMOTE PROCEDURE
+-----------------------------------------------------------------
+Cost depends on the argument (low 10 bits = rounds), so
+short requests finish before long ones sent earlier.
+*/
+static uint64_t rpc_hash(uint64_t arg)
+{
+    uint64_t h = arg ^ 0x9e3779b97f4a7c15ULL;
+    unsigned rounds = 64 + (arg & 1023) * 4;
+
+    for (unsigned i = 0; i < rounds; i++)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+    }
+    return h;
+}
+
+/*
+-----------------------------------------------------------------
+SERVER STATE (CHILD PROCESS)
+-----------------------------------------------------------------
+*/
+struct server
+{
+    int fd;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t done_ready;
+
+    struct rpc_request queue[QUEUE_SIZE];     /* receiver -> workers */
+    unsigned q_head, q_tail;
+
+    struct rpc_result done[QUEUE_SIZE];       /* workers -> responder */
+    unsigned d_count;
+
+    int closing;                              /* client hung up */
+    int busy_workers;
+};
+
+/*
+-----------------------------------------------------------------
+SERVER: RECEIVER THREAD
+-----------------------------------------------------------------
+*/
+static void *receiver_thread(void *arg)
+{
+    struct server *s = arg;
+    struct rpc_request req;
+
+    for (;;)
+    {
+        ssize_t n = recv(s->fd, &req, sizeof(req), 0);
+        if (n != (ssize_t)sizeof(req))
+        {
+            break;          /* 0 = client closed its end */
+        }
+
+        pthread_mutex_lock(&s->lock);
+        s->queue[s->q_tail++ % QUEUE_SIZE] = req;
+        pthread_cond_signal(&s->work_ready);
+        pthread_mutex_unlock(&s->lock);
+    }
+
+    pthread_mutex_lock(&s->lock);
+    s->closing = 1;
+    pthread_cond_broadcast(&s->work_ready);
+    pthread_cond_broadcast(&s->done_ready);
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+SERVER: WORKER THREAD
+-----------------------------------------------------------------
+*/
+static void *worker_thread(void *arg)
+{
+    struct server *s = arg;
+
+    pthread_mutex_lock(&s->lock);
+    for (;;)
+    {
+        while (s->q_head == s->q_tail && !s->closing)
+        {
+            pthread_cond_wait(&s->work_ready, &s->lock);
+        }
+        if (s->q_head == s->q_tail)
+        {
+            break;
+        }
+
+        struct rpc_request req = s->queue[s->q_head++ % QUEUE_SIZE];
+        s->busy_workers++;
+        pthread_mutex_unlock(&s->lock);
+
+        struct rpc_result res = { .id = req.id, .pad = 0, .result = 0 };
+        if (req.op == OP_HASH)
+        {
+            res.result = rpc_hash(req.arg);
+        }
+
+        pthread_mutex_lock(&s->lock);
+        s->busy_workers--;
+        s->done[s->d_count++] = res;
+        pthread_cond_signal(&s->done_ready);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+SERVER: RESPONDER THREAD (BATCHES COMPLETIONS)
+-----------------------------------------------------------------
+*/
+static void *responder_thread(void *arg)
+{
+    struct server *s = arg;
+    struct rpc_response resp;
+
+    pthread_mutex_lock(&s->lock);
+    for (;;)
+    {
+        while (s->d_count == 0 &&
+               !(s->closing && s->q_head == s->q_tail && s->busy_workers == 0))
+        {
+            pthread_cond_wait(&s->done_ready, &s->lock);
+        }
+        if (s->d_count == 0)
+        {
+            break;          /* closing and fully drained */
+        }
+
+        /* Take up to RPC_BATCH completions in one packet */
+        unsigned take = s->d_count < RPC_BATCH ? s->d_count : RPC_BATCH;
+        memcpy(resp.results, &s->done[s->d_count - take], take * sizeof(resp.results[0]));
+        s->d_count -= take;
+        pthread_mutex_unlock(&s->lock);
+
+        resp.count = take;
+        resp.pad = 0;
+        size_t len = offsetof(struct rpc_response, results) + take * sizeof(resp.results[0]);
+        if (send(s->fd, &resp, len, MSG_NOSIGNAL) != (ssize_t)len)
+        {
+            return NULL;    /* client gone */
+        }
+
+        pthread_mutex_lock(&s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+/*
+-----------------------------------------------------------------
+SERVER MAIN
+-----------------------------------------------------------------
+*/
+static void server_main(int fd, int workers)
+{
+    static struct server s;
+    pthread_t recv_tid, resp_tid, tids[64];
+
+    memset(&s, 0, sizeof(s));
+    s.fd = fd;
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.work_ready, NULL);
+    pthread_cond_init(&s.done_ready, NULL);
+
+    pthread_create(&recv_tid, NULL, receiver_thread, &s);
+    pthread_create(&resp_tid, NULL, responder_thread, &s);
+    for (int i = 0; i < workers; i++)
+    {
+        pthread_create(&tids[i], NULL, worker_thread, &s);
+    }
+
+    pthread_join(recv_tid, NULL);
+    for (int i = 0; i < workers; i++)
+    {
+        pthread_join(tids[i], NULL);
+    }
+    pthread_cond_broadcast(&s.done_ready);
+    pthread_join(resp_tid, NULL);
+    close(fd);
+    exit(0);
+}
+
+/*
+-----------------------------------------------------------------
+CLIENT: IN-FLIGHT TABLE
+-----------------------------------------------------------------
+ID = (generation << 16) | slot. The generation catches a
+stale or duplicated reply for a slot that was reused.
+*/
+struct slot
+{
+    uint32_t gen;
+    int busy;
+    uint64_t arg;
+    uint64_t seq;           /* send order, for out-of-order count */
+};
+
+struct client_stats
+{
+    double seconds;
+    long packets;
+    long out_of_order;
+    long errors;
+};
+
+static int run_depth(int fd, int depth, long total, struct client_stats *st)
+{
+    static struct slot slots[MAX_DEPTH];
+    int free_list[MAX_DEPTH], free_top = 0;
+    struct rpc_response resp;
+    long sent = 0, done = 0;
+    uint64_t next_expected = 0;     /* oldest unanswered seq */
+    uint64_t rng = 88172645463325252ULL;
+
+    memset(st, 0, sizeof(*st));
+    for (int i = depth - 1; i >= 0; i--)
+    {
+        slots[i].busy = 0;
+        free_list[free_top++] = i;
+    }
+
+    double t0 = now_sec();
+    while (done < total)
+    {
+        /*
+        Fill the window
+        */
+        while (free_top > 0 && sent < total)
+        {
+            int i = free_list[--free_top];
+            struct rpc_request req;
+
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+
+            slots[i].gen++;
+            slots[i].busy = 1;
+            slots[i].arg = rng;
+            slots[i].seq = sent;
+
+            req.id = (slots[i].gen << 16) | (uint32_t)i;
+            req.op = OP_HASH;
+            req.arg = rng;
+            if (send(fd, &req, sizeof(req), MSG_NOSIGNAL) != (ssize_t)sizeof(req))
+            {
+                perror("send failed");
+                return -1;
+            }
+            sent++;
+        }
+
+        /*
+        One packet may carry many answers
+        */
+        ssize_t n = recv(fd, &resp, sizeof(resp), 0);
+        if (n < (ssize_t)offsetof(struct rpc_response, results))
+        {
+            perror("recv failed");
+            return -1;
+        }
+        st->packets++;
+
+        for (uint32_t k = 0; k < resp.count; k++)
+        {
+            uint32_t i = resp.results[k].id & 0xffff;
+            uint32_t gen = resp.results[k].id >> 16;
+
+            if (i >= (uint32_t)depth || !slots[i].busy || (slots[i].gen & 0xffff) != gen)
+            {
+                st->errors++;
+                continue;
+            }
+            if (resp.results[k].result != rpc_hash(slots[i].arg))
+            {
+                st->errors++;
+            }
+            if (slots[i].seq != next_expected)
+            {
+                st->out_of_order++;
+            }
+            slots[i].busy = 0;
+            free_list[free_top++] = (int)i;
+            done++;
+
+            /* Advance to the oldest still-busy request */
+            next_expected = sent;
+            for (int j = 0; j < depth; j++)
+            {
+                if (slots[j].busy && slots[j].seq < next_expected)
+                {
+                    next_expected = slots[j].seq;
+                }
+            }
+        }
+    }
+    st->seconds = now_sec() - t0;
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program measures a pipelined SEQPACKET RPC.
+*/
+int main(int argc, char *argv[])
+{
+    long total = argc > 1 ? atol(argv[1]) : 200000;
+    int workers = argc > 2 ? atoi(argv[2]) : 4;
+    int sv[2];
+
+    if (total <= 0 || workers < 1 || workers > 64)
+    {
+        fprintf(stderr, "usage: %s [requests_per_depth] [workers 1-64]\n", argv[0]);
+        return 1;
+    }
+
+    /*
+    STEP 1: Create the SEQPACKET socketpair
+    ---------------------------------------
+    */
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) == -1)
+    {
+        perror("socketpair failed");
+        return 1;
+    }
+
+    /*
+    STEP 2: Fork the server
+    -----------------------
+    */
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        perror("fork failed");
+        return 1;
+    }
+    if (pid == 0)
+    {
+        close(sv[0]);
+        server_main(sv[1], workers);
+    }
+    close(sv[1]);
+
+    /*
+    STEP 3: Run every pipeline depth
+    --------------------------------
+    */
+    printf("%ld requests per depth, %d workers, batch <= %d\n\n", total, workers, RPC_BATCH);
+    printf("%6s %12s %10s %14s %14s %7s\n",
+           "depth", "req/s", "avg us", "resp/packet", "out-of-order", "errors");
+
+    for (int depth = 1; depth <= MAX_DEPTH; depth *= 2)
+    {
+        struct client_stats st;
+
+        if (run_depth(sv[0], depth, total, &st) == -1)
+        {
+            return 1;
+        }
+
+        /*
+        STEP 4: Report
+        --------------
+        */
+        printf("%6d %12.0f %10.2f %14.2f %13.1f%% %7ld\n", depth, total / st.seconds,
+               st.seconds / total * 1e6 * depth, (double)total / st.packets,
+               100.0 * st.out_of_order / total, st.errors);
+    }
+
+    /*
+    STEP 5: Hang up; the server drains and exits
+    --------------------------------------------
+    */
+    close(sv[0]);
+    waitpid(pid, NULL, 0);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. SOCK_SEQPACKET keeps message boundaries (no framing)
+2. Request ID lets replies come back in any order
+3. depth = requests in flight; depth 1 = blocking RPC
+4. Slot + generation in the ID catches stale replies
+5. Worker pool: long requests do not block short ones
+6. Batch responses: one send() carries many answers
+7. Throughput grows with depth until workers or syscalls
+   saturate; per-request latency then grows instead
+
+DEFINITION (IN SIMPLE WORDS):
+Pipelined RPC: drop many numbered letters in the box at
+once; answers come back in any order, bundled together.
+
+REAL-TIME EXAMPLES:
+- HTTP/2 and gRPC streams on one connection
+- Redis pipelining
+- NFS / 9P / FUSE request tags
+- Database wire protocols with async queries
+
+=================================================================
+*/
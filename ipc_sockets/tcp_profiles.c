@@ -0,0 +1,519 @@
+/*
+=================================================================
+TCP LATENCY vs THROUGHPUT PROFILES – NODELAY / CORK (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. Why small request/response exchanges can stall for ~40 ms
+   (Nagle's algorithm + delayed ACK)
+2. A LATENCY profile: TCP_NODELAY + TCP_QUICKACK
+3. A THROUGHPUT profile: TCP_CORK / MSG_MORE with an explicit
+   uncork at message boundaries
+4. A tiny profile API used by both client and server
+5. A loopback benchmark showing both effects
+
+DEFINITION:
+Nagle's algorithm holds back a small segment while earlier
+data is still unacknowledged. Delayed ACK makes the receiver
+wait (up to ~40 ms) before acknowledging. Together, a
+"write header, write body, then wait for the reply" client
+stalls: the body waits for an ACK, the ACK waits for a timer.
+
+TCP_NODELAY disables Nagle (every send goes out now).
+TCP_CORK does the opposite: hold ALL partial segments until
+the cork is removed, so many small writes become full
+segments. MSG_MORE is a per-call cork ("more is coming").
+
+SYNTAX (MAJOR CALLS USED):
+int setsockopt(int fd, IPPROTO_TCP, TCP_NODELAY, &on, len);
+int setsockopt(int fd, IPPROTO_TCP, TCP_QUICKACK, &on, len);
+int setsockopt(int fd, IPPROTO_TCP, TCP_CORK, &on, len);
+ssize_t send(int fd, const void *buf, size_t len, MSG_MORE);
+int getsockopt(int fd, IPPROTO_TCP, TCP_INFO, &info, &len);
+
+SYNTAX EXPLANATION:
+TCP_NODELAY = 1   -> Disable Nagle (latency)
+TCP_QUICKACK = 1  -> ACK immediately; NOT permanent, the
+                     kernel may clear it, so re-arm after recv
+TCP_CORK = 1 / 0  -> Hold / flush partial segments
+MSG_MORE          -> Hold this send, more data follows
+tcpi_segs_out     -> Segments sent on this connection
+
+PROFILE API:
+struct tcp_conn { fd, profile }  -> socket + its profile
+tcp_apply_profile(c, fd, profile)-> set options once
+tcp_send_part(c, buf, len, more) -> send one part of a message
+tcp_message_end(c)               -> message boundary: uncork
+tcp_after_recv(c)                -> re-arm QUICKACK
+
+KEY POINTS:
+- default    : Nagle on, delayed ACK on
+- latency    : NODELAY + QUICKACK, every part sent at once
+- throughput : CORK, parts coalesced, flushed at the end of
+               a batch of messages (the message boundary)
+- Request/response test: header + body written separately
+- Bulk test: many 100-byte messages; segments counted with
+  TCP_INFO to show coalescing
+
+WHY PROFILES?
+- RPC / interactive traffic needs LOW LATENCY
+- Bulk transfer / logging needs FEW, FULL segments
+- One connection type rarely fits both defaults
+
+IMPORTANT APIs:
+socket()/bind()/listen()/accept()/connect()
+setsockopt()      -> Apply profile
+send()/recv()     -> Data transfer
+getsockopt(TCP_INFO) -> Segment statistics
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Creates a listening socket on 127.0.0.1
+STEP 2: Request/response test per profile: client sends a
+        16-byte header and a 48-byte body, waits for a
+        64-byte reply; measures average round trip
+STEP 3: Bulk test per profile: client sends 100-byte
+        messages in two parts; measures MB/s and the
+        average bytes per TCP segment
+STEP 4: Prints both tables
+
+COMPILE:
+gcc -O2 tcp_profiles.c
+./a.out [request_seconds] [bulk_mb]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Request/response: default shows ~40 ms stalls,
+   latency and throughput profiles do not
+2. Bulk: latency profile sends many small segments,
+   throughput profile sends few large ones
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>          // For printf(), perror()
+#include <stdlib.h>         // For atof(), atoi()
+#include <string.h>         // For memset()
+#include <signal.h>         // For kill()
+#include <time.h>           // For clock_gettime()
+#include <unistd.h>         // For fork(), close()
+#include <arpa/inet.h>      // For inet_pton()
+#include <netinet/in.h>     // For struct sockaddr_in
+#include <linux/tcp.h>      // For TCP_NODELAY, TCP_CORK, struct tcp_info
+#include <sys/socket.h>     // For socket(), send(), recv()
+#include <sys/wait.h>       // For waitpid()
+
+#define HEADER_SIZE     16
+#define BODY_SIZE       48
+#define REQUEST_SIZE    (HEADER_SIZE + BODY_SIZE)
+#define BULK_MSG        100
+#define BULK_HEADER     8
+#define BULK_BATCH      64     /* messages per uncork */
+
+enum tcp_profile { PROFILE_DEFAULT, PROFILE_LATENCY, PROFILE_THROUGHPUT };
+
+static const char *profile_names[] = { "default", "latency", "throughput" };
+
+enum test { TEST_REQUEST, TEST_BULK };
+
+/*
+A socket together with its profile; the send helpers need both.
+*/
+struct tcp_conn
+{
+    int              fd;
+    enum tcp_profile profile;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN SECONDS
+-----------------------------------------------------------------
+*/
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+-----------------------------------------------------------------
+PROFILE API
+-----------------------------------------------------------------
+*/
+static int tcp_apply_profile(struct tcp_conn *c, int fd, enum tcp_profile p)
+{
+    int one = 1;
+
+    c->fd = fd;
+    c->profile = p;
+
+    switch (p)
+    {
+    case PROFILE_LATENCY:
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) == -1 ||
+            setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one)) == -1)
+        {
+            return -1;
+        }
+        break;
+    case PROFILE_THROUGHPUT:
+        if (setsockopt(fd, IPPROTO_TCP, TCP_CORK, &one, sizeof(one)) == -1)
+        {
+            return -1;
+        }
+        break;
+    default:
+        break;
+    }
+    return 0;
+}
+
+/* One part of a message; 'more' = more parts follow */
+static ssize_t tcp_send_part(const struct tcp_conn *c, const void *buf, size_t len, int more)
+{
+    int flags = MSG_NOSIGNAL;
+
+    if (c->profile == PROFILE_THROUGHPUT && more)
+    {
+        flags |= MSG_MORE;
+    }
+    return send(c->fd, buf, len, flags);
+}
+
+/* Message boundary: push out everything held by the cork */
+static int tcp_message_end(const struct tcp_conn *c)
+{
+    int off = 0, on = 1;
+
+    if (c->profile != PROFILE_THROUGHPUT)
+    {
+        return 0;
+    }
+    if (setsockopt(c->fd, IPPROTO_TCP, TCP_CORK, &off, sizeof(off)) == -1)
+    {
+        return -1;
+    }
+    return setsockopt(c->fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on));
+}
+
+/* QUICKACK is cleared by the kernel; re-arm after reads */
+static void tcp_after_recv(const struct tcp_conn *c)
+{
+    int one = 1;
+
+    if (c->profile == PROFILE_LATENCY)
+    {
+        setsockopt(c->fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+    }
+}
+
+/*
+-----------------------------------------------------------------
+HELPERS: SEND ALL / RECEIVE EXACTLY N BYTES
+-----------------------------------------------------------------
+*/
+static int send_all(const struct tcp_conn *c, const char *buf, size_t len, int more)
+{
+    while (len > 0)
+    {
+        ssize_t n = tcp_send_part(c, buf, len, more);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int recv_exact(const struct tcp_conn *c, char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = recv(c->fd, buf, len, 0);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        tcp_after_recv(c);
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+SERVER (CHILD PROCESS)
+-----------------------------------------------------------------
+Request test: reply 64 bytes per 64-byte request.
+Bulk test   : drain everything.
+*/
+static void server_main(int listen_fd, enum test test, enum tcp_profile p)
+{
+    char buf[65536];
+    struct tcp_conn c;
+    int fd = accept(listen_fd, NULL, NULL);
+
+    if (fd == -1 || tcp_apply_profile(&c, fd, p) == -1)
+    {
+        _exit(1);
+    }
+
+    if (test == TEST_BULK)
+    {
+        while (recv(c.fd, buf, sizeof(buf), 0) > 0)
+        {
+            tcp_after_recv(&c);
+        }
+        _exit(0);
+    }
+
+    while (recv_exact(&c, buf, REQUEST_SIZE) == 0)
+    {
+        /* Reply is one part: header and body together */
+        if (send_all(&c, buf, REQUEST_SIZE, 0) == -1 || tcp_message_end(&c) == -1)
+        {
+            break;
+        }
+    }
+    _exit(0);
+}
+
+/*
+-----------------------------------------------------------------
+CONNECT A CLIENT WITH A PROFILE
+-----------------------------------------------------------------
+*/
+static int connect_client(struct tcp_conn *c, const struct sockaddr_in *addr, enum tcp_profile p)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd == -1 || connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) == -1 ||
+        tcp_apply_profile(c, fd, p) == -1)
+    {
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+REQUEST / RESPONSE TEST
+-----------------------------------------------------------------
+*/
+static int request_test(int listen_fd, const struct sockaddr_in *addr,
+                        enum tcp_profile p, double seconds)
+{
+    char req[REQUEST_SIZE], reply[REQUEST_SIZE];
+    struct tcp_conn c;
+    double worst = 0;
+    long count = 0;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        server_main(listen_fd, TEST_REQUEST, p);
+    }
+
+    if (pid == -1 || connect_client(&c, addr, p) == -1)
+    {
+        perror("request test setup failed");
+        return -1;
+    }
+    memset(req, 'r', sizeof(req));
+
+    double start = now_sec();
+    while (now_sec() - start < seconds)
+    {
+        double t0 = now_sec();
+
+        /* Header and body as two writes: the classic stall */
+        if (send_all(&c, req, HEADER_SIZE, 1) == -1 ||
+            send_all(&c, req + HEADER_SIZE, BODY_SIZE, 0) == -1 ||
+            tcp_message_end(&c) == -1 ||
+            recv_exact(&c, reply, REQUEST_SIZE) == -1)
+        {
+            perror("request failed");
+            break;
+        }
+
+        double rtt = now_sec() - t0;
+        if (rtt > worst)
+        {
+            worst = rtt;
+        }
+        count++;
+    }
+    double elapsed = now_sec() - start;
+
+    close(c.fd);
+    waitpid(pid, NULL, 0);
+
+    printf("%-11s %9ld %10.0f %11.1f %11.1f\n", profile_names[p], count, count / elapsed,
+           count ? elapsed / count * 1e6 : 0.0, worst * 1e6);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+BULK TEST
+-----------------------------------------------------------------
+*/
+static int bulk_test(int listen_fd, const struct sockaddr_in *addr,
+                     enum tcp_profile p, long bytes)
+{
+    char msg[BULK_MSG];
+    struct tcp_conn c;
+    struct tcp_info info;
+    socklen_t len = sizeof(info);
+    long messages = bytes / BULK_MSG;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        server_main(listen_fd, TEST_BULK, p);
+    }
+
+    if (pid == -1 || connect_client(&c, addr, p) == -1)
+    {
+        perror("bulk test setup failed");
+        return -1;
+    }
+    memset(msg, 'b', sizeof(msg));
+
+    double t0 = now_sec();
+    for (long i = 0; i < messages; i++)
+    {
+        /* Two parts per message: header + payload */
+        if (send_all(&c, msg, BULK_HEADER, 1) == -1 ||
+            send_all(&c, msg + BULK_HEADER, BULK_MSG - BULK_HEADER, 1) == -1)
+        {
+            perror("send failed");
+            break;
+        }
+        if ((i + 1) % BULK_BATCH == 0 && tcp_message_end(&c) == -1)
+        {
+            perror("uncork failed");
+            break;
+        }
+    }
+    tcp_message_end(&c);
+
+    memset(&info, 0, sizeof(info));
+    getsockopt(c.fd, IPPROTO_TCP, TCP_INFO, &info, &len);
+    shutdown(c.fd, SHUT_WR);
+    waitpid(pid, NULL, 0);   /* receiver has drained everything */
+    double elapsed = now_sec() - t0;
+    close(c.fd);
+
+    printf("%-11s %10.1f %10.0f %12u %12.0f\n", profile_names[p],
+           messages * BULK_MSG / 1048576.0, messages * BULK_MSG / 1048576.0 / elapsed,
+           info.tcpi_segs_out,
+           info.tcpi_segs_out ? (double)messages * BULK_MSG / info.tcpi_segs_out : 0.0);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares TCP socket profiles on loopback.
+*/
+int main(int argc, char *argv[])
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+    long bulk_bytes = (long)(argc > 2 ? atoi(argv[2]) : 64) * 1024 * 1024;
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    if (seconds <= 0 || bulk_bytes <= 0)
+    {
+        fprintf(stderr, "usage: %s [request_seconds] [bulk_mb]\n", argv[0]);
+        return 1;
+    }
+
+    /*
+    STEP 1: Listening socket
+    ------------------------
+    */
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    if (listen_fd == -1 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(listen_fd, 16) == -1 ||
+        getsockname(listen_fd, (struct sockaddr *)&addr, &len) == -1)
+    {
+        perror("listen socket failed");
+        return 1;
+    }
+
+    /*
+    STEP 2: Request / response
+    --------------------------
+    */
+    printf("Request/response (%d-byte header + %d-byte body, %d-byte reply):\n",
+           HEADER_SIZE, BODY_SIZE, REQUEST_SIZE);
+    printf("%-11s %9s %10s %11s %11s\n", "profile", "requests", "req/s", "avg us", "worst us");
+    for (enum tcp_profile p = PROFILE_DEFAULT; p <= PROFILE_THROUGHPUT; p++)
+    {
+        if (request_test(listen_fd, &addr, p, seconds) == -1)
+        {
+            return 1;
+        }
+    }
+
+    /*
+    STEP 3: Bulk transfer
+    ---------------------
+    */
+    printf("\nBulk (%d-byte messages in 2 parts, uncork every %d):\n", BULK_MSG, BULK_BATCH);
+    printf("%-11s %10s %10s %12s %12s\n", "profile", "MB", "MB/s", "segments", "bytes/seg");
+    for (enum tcp_profile p = PROFILE_DEFAULT; p <= PROFILE_THROUGHPUT; p++)
+    {
+        if (bulk_test(listen_fd, &addr, p, bulk_bytes) == -1)
+        {
+            return 1;
+        }
+    }
+
+    close(listen_fd);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Nagle + delayed ACK = write-write-read stalls (~40 ms)
+2. TCP_NODELAY: send small segments immediately
+3. TCP_QUICKACK: ACK now; re-arm it after every recv()
+4. TCP_CORK: collect small writes into full segments
+5. MSG_MORE: per-call cork for "header now, body next"
+6. Uncork at message boundaries, or data waits up to 200 ms
+7. TCP_INFO tcpi_segs_out shows how many segments were sent
+
+DEFINITION (IN SIMPLE WORDS):
+Latency mode: send every small note right away.
+Throughput mode: fill the envelope first, then send it.
+
+REAL-TIME EXAMPLES:
+- Redis, memcached, gRPC set TCP_NODELAY
+- nginx uses TCP_CORK / TCP_NOPUSH with sendfile()
+- HTTP servers: headers + body with MSG_MORE
+- Log forwarders batching records
+
+=================================================================
+*/
@@ -0,0 +1,452 @@
+/*
+=================================================================
+UDP GSO / GRO – MANY DATAGRAMS PER SYSCALL (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to send and receive UDP datagrams over loopback
+2. How sendmmsg() / recvmmsg() move many datagrams per call
+3. How UDP_SEGMENT (GSO) sends ONE large buffer that the
+   kernel splits into equal-sized datagrams
+4. How UDP_GRO receives coalesced batches plus the segment
+   size in a control message
+5. How packets/s and CPU/packet compare with one datagram
+   per syscall
+
+DEFINITION:
+GSO (Generic Segmentation Offload) lets the sender hand the
+kernel a "super packet" of up to 64 KB together with a segment
+size. The stack keeps it as one unit for as long as possible
+and cuts it into real datagrams at the end. GRO (Generic
+Receive Offload) is the reverse: consecutive datagrams of the
+same flow are merged and delivered in one recvmsg() with the
+segment size attached.
+
+SYNTAX (MAJOR CALLS USED):
+int sendmmsg(int fd, struct mmsghdr *vec, unsigned int n,
+             int flags);
+int recvmmsg(int fd, struct mmsghdr *vec, unsigned int n,
+             int flags, struct timespec *timeout);
+int setsockopt(fd, SOL_UDP, UDP_SEGMENT, &gso_size, sizeof(int));
+int setsockopt(fd, SOL_UDP, UDP_GRO, &one, sizeof(int));
+
+SYNTAX EXPLANATION:
+struct mmsghdr    -> { struct msghdr msg_hdr; msg_len }
+UDP_SEGMENT       -> Segment size for every send on the socket
+                     (or per call in a cmsg)
+UDP_GRO           -> Receiver accepts coalesced batches
+cmsg SOL_UDP / UDP_GRO -> int: size of each segment
+segments          -> (bytes + gso_size - 1) / gso_size
+
+KEY POINTS:
+- Modes: plain (sendto/recv), mmsg (sendmmsg/recvmmsg),
+  gso (UDP_SEGMENT + UDP_GRO), gso+mmsg (both)
+- Payload 1200 bytes, 50 segments per GSO buffer (60000 B)
+- Sender is a child process; receiver is the parent
+- End of test: sender closes a pipe, receiver drains socket
+- UDP can drop packets when the receiver is slower:
+  loss is reported, SO_RCVBUF is raised
+- Kernels without GSO / GRO show the mode as n/a
+
+WHY GSO / GRO?
+- Per-packet cost (syscall, routing, socket lookup) is
+  paid once per batch instead of once per datagram
+- QUIC (HTTP/3) stacks rely on it for throughput
+- Telemetry / metrics over UDP with high packet rates
+
+IMPORTANT APIs:
+socket(AF_INET, SOCK_DGRAM) -> UDP socket
+sendmmsg()/recvmmsg()       -> Batch syscalls
+setsockopt(UDP_SEGMENT)     -> GSO
+setsockopt(UDP_GRO)         -> GRO
+wait4()/getrusage()         -> CPU per packet
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Creates a receiver socket bound to 127.0.0.1:0
+STEP 2: For each mode: forks the sender, receives until the
+        sender is done and the socket is drained
+STEP 3: Computes packets/s (sender and receiver), loss and
+        CPU nanoseconds per packet on both sides
+STEP 4: Prints a table
+
+COMPILE:
+gcc -O2 udp_gso.c
+./a.out [packets]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Table: mode, sent, received, loss %, send pps, recv pps,
+   sender ns CPU / packet, receiver ns CPU / packet
+2. gso rows show far lower CPU per packet than plain
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>          // For printf(), perror()
+#include <stdlib.h>         // For atol()
+#include <string.h>         // For memset()
+#include <errno.h>          // For errno
+#include <fcntl.h>          // For fcntl()
+#include <poll.h>           // For poll()
+#include <time.h>           // For clock_gettime()
+#include <unistd.h>         // For fork(), pipe(), close()
+#include <arpa/inet.h>      // For inet_pton()
+#include <netinet/in.h>     // For struct sockaddr_in
+#include <netinet/udp.h>    // For SOL_UDP, UDP_SEGMENT
+#include <sys/resource.h>   // For getrusage(), struct rusage
+#include <sys/socket.h>     // For sendmmsg(), recvmmsg()
+#include <sys/wait.h>       // For wait4()
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT  103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO      104
+#endif
+
+#define PAYLOAD      1200
+#define GSO_SEGS     50
+#define GSO_BYTES    (PAYLOAD * GSO_SEGS)
+#define BATCH        32
+#define RX_BUF       65536
+
+enum mode { MODE_PLAIN, MODE_MMSG, MODE_GSO, MODE_GSO_MMSG };
+
+static const char *mode_names[] = { "plain", "mmsg", "gso", "gso+mmsg" };
+
+/*
+What the sender reports back through the pipe.
+*/
+struct send_report
+{
+    unsigned long sent;
+    double        seconds;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN SECONDS
+-----------------------------------------------------------------
+*/
+static double now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu_of(const struct rusage *ru)
+{
+    return ru->ru_utime.tv_sec + ru->ru_stime.tv_sec +
+           (ru->ru_utime.tv_usec + ru->ru_stime.tv_usec) / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+SENDER (CHILD PROCESS)
+-----------------------------------------------------------------
+Sends 'packets' datagrams of PAYLOAD bytes in the given mode.
+*/
+static void sender_main(enum mode mode, const struct sockaddr_in *dst,
+                        unsigned long packets, int report_fd)
+{
+    static char buf[BATCH][GSO_BYTES];
+    struct mmsghdr msgs[BATCH];
+    struct iovec iov[BATCH];
+    struct send_report rep = { 0, 0 };
+    int gso = mode == MODE_GSO || mode == MODE_GSO_MMSG;
+    int seg = PAYLOAD;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1 || connect(fd, (const struct sockaddr *)dst, sizeof(*dst)) == -1)
+    {
+        _exit(1);
+    }
+    if (gso && setsockopt(fd, SOL_UDP, UDP_SEGMENT, &seg, sizeof(seg)) == -1)
+    {
+        _exit(2);   /* GSO not supported */
+    }
+    memset(buf, 'u', sizeof(buf));
+
+    /* Datagrams carried by one message */
+    unsigned long per_msg = gso ? GSO_SEGS : 1;
+    size_t msg_bytes = gso ? GSO_BYTES : PAYLOAD;
+
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < BATCH; i++)
+    {
+        iov[i].iov_base = buf[i];
+        iov[i].iov_len = msg_bytes;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    double t0 = now_sec();
+    while (rep.sent < packets)
+    {
+        if (mode == MODE_PLAIN || mode == MODE_GSO)
+        {
+            if (send(fd, buf[0], msg_bytes, 0) == (ssize_t)msg_bytes)
+            {
+                rep.sent += per_msg;
+            }
+        }
+        else
+        {
+            unsigned long left = (packets - rep.sent + per_msg - 1) / per_msg;
+            int n = sendmmsg(fd, msgs, left < BATCH ? (unsigned int)left : BATCH, 0);
+            if (n > 0)
+            {
+                rep.sent += n * per_msg;
+            }
+        }
+    }
+    rep.seconds = now_sec() - t0;
+
+    if (write(report_fd, &rep, sizeof(rep)) != sizeof(rep))
+    {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+/*
+-----------------------------------------------------------------
+COUNT DATAGRAMS IN ONE RECEIVED MESSAGE
+-----------------------------------------------------------------
+With GRO the control message carries the segment size.
+*/
+static unsigned long segments_in(struct msghdr *msg, size_t len)
+{
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(msg); c != NULL; c = CMSG_NXTHDR(msg, c))
+    {
+        if (c->cmsg_level == SOL_UDP && c->cmsg_type == UDP_GRO)
+        {
+            int gso_size;
+            memcpy(&gso_size, CMSG_DATA(c), sizeof(gso_size));
+            if (gso_size > 0)
+            {
+                return (len + gso_size - 1) / gso_size;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+-----------------------------------------------------------------
+RECEIVE ONE BATCH (MODE DEPENDENT)
+-----------------------------------------------------------------
+Returns datagrams received, 0 if nothing was waiting.
+*/
+static unsigned long receive_batch(int fd, enum mode mode)
+{
+    static char bufs[BATCH][RX_BUF];
+    static char ctrl[BATCH][CMSG_SPACE(sizeof(int))];
+    struct mmsghdr msgs[BATCH];
+    struct iovec iov[BATCH];
+    unsigned long count = 0;
+
+    if (mode == MODE_PLAIN)
+    {
+        return recv(fd, bufs[0], RX_BUF, MSG_DONTWAIT) > 0 ? 1 : 0;
+    }
+
+    int batch = mode == MODE_GSO ? 1 : BATCH;
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < batch; i++)
+    {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = RX_BUF;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = ctrl[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+    }
+
+    int n = recvmmsg(fd, msgs, batch, MSG_DONTWAIT, NULL);
+    for (int i = 0; i < n; i++)
+    {
+        count += segments_in(&msgs[i].msg_hdr, msgs[i].msg_len);
+    }
+    return count;
+}
+
+/*
+-----------------------------------------------------------------
+RUN ONE MODE
+-----------------------------------------------------------------
+*/
+static int run_mode(enum mode mode, unsigned long packets)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int one = 1, rcvbuf = 16 * 1024 * 1024;
+
+    /* Fresh receiver per mode: no leftovers from the last run */
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (fd == -1 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        getsockname(fd, (struct sockaddr *)&addr, &len) == -1)
+    {
+        perror("receiver socket failed");
+        return -1;
+    }
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) == -1)
+    {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    if ((mode == MODE_GSO || mode == MODE_GSO_MMSG) &&
+        setsockopt(fd, SOL_UDP, UDP_GRO, &one, sizeof(one)) == -1)
+    {
+        printf("%-9s GRO not supported\n", mode_names[mode]);
+        close(fd);
+        return 0;
+    }
+
+    int report[2];
+    if (pipe(report) == -1)
+    {
+        perror("pipe failed");
+        return -1;
+    }
+
+    struct rusage self0, self1, child;
+    getrusage(RUSAGE_SELF, &self0);
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        perror("fork failed");
+        return -1;
+    }
+    if (pid == 0)
+    {
+        close(report[0]);
+        sender_main(mode, &addr, packets, report[1]);
+    }
+    close(report[1]);
+
+    /* Receive until the sender reported and the socket is empty */
+    struct pollfd pfd[2] = { { fd, POLLIN, 0 }, { report[0], POLLIN, 0 } };
+    struct send_report rep = { 0, 0 };
+    unsigned long received = 0;
+    double first = 0, last = 0;
+    int sender_done = 0;
+
+    while (!sender_done || pfd[0].revents & POLLIN)
+    {
+        if (poll(pfd, 2, sender_done ? 50 : -1) <= 0)
+        {
+            break;
+        }
+        if (pfd[0].revents & POLLIN)
+        {
+            unsigned long n;
+            while ((n = receive_batch(fd, mode)) > 0)
+            {
+                if (received == 0)
+                {
+                    first = now_sec();
+                }
+                received += n;
+            }
+            last = now_sec();
+        }
+        if (!sender_done && pfd[1].revents & (POLLIN | POLLHUP))
+        {
+            if (read(report[0], &rep, sizeof(rep)) != sizeof(rep))
+            {
+                rep.sent = 0;
+            }
+            sender_done = 1;
+            pfd[1].fd = -1;
+        }
+    }
+
+    getrusage(RUSAGE_SELF, &self1);
+    int status;
+    wait4(pid, &status, 0, &child);
+    close(report[0]);
+    close(fd);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 2)
+    {
+        printf("%-9s GSO not supported\n", mode_names[mode]);
+        return 0;
+    }
+
+    double rx_cpu = cpu_of(&self1) - cpu_of(&self0);
+    double rx_time = last > first ? last - first : 1e-9;
+
+    printf("%-9s %9lu %9lu %6.1f%% %10.0f %10.0f %9.0f %9.0f\n", mode_names[mode],
+           rep.sent, received, rep.sent ? 100.0 * (rep.sent - received) / rep.sent : 0.0,
+           rep.seconds > 0 ? rep.sent / rep.seconds : 0.0, received / rx_time,
+           rep.sent ? cpu_of(&child) * 1e9 / rep.sent : 0.0,
+           received ? rx_cpu * 1e9 / received : 0.0);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares UDP send / receive strategies.
+*/
+int main(int argc, char *argv[])
+{
+    unsigned long packets = argc > 1 ? strtoul(argv[1], NULL, 10) : 500000;
+
+    if (packets == 0)
+    {
+        fprintf(stderr, "usage: %s [packets]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%lu datagrams of %d bytes over 127.0.0.1\n\n", packets, PAYLOAD);
+    printf("%-9s %9s %9s %7s %10s %10s %9s %9s\n", "mode", "sent", "received", "loss",
+           "send pps", "recv pps", "tx ns/pkt", "rx ns/pkt");
+
+    for (enum mode m = MODE_PLAIN; m <= MODE_GSO_MMSG; m++)
+    {
+        if (run_mode(m, packets) == -1)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. One datagram per syscall = per-packet overhead dominates
+2. sendmmsg()/recvmmsg(): many messages, one syscall
+3. UDP_SEGMENT: one 60 KB send -> 50 datagrams of 1200 B
+4. UDP_GRO: receiver gets merged batches + segment size cmsg
+5. Segments = ceil(bytes / gso_size)
+6. UDP may drop: always measure loss, raise SO_RCVBUF
+7. Combine GSO with sendmmsg for the fewest syscalls
+
+DEFINITION (IN SIMPLE WORDS):
+Instead of mailing 50 letters one by one, hand the post
+office one big envelope and say "split this into 50
+letters of this size"; the receiver can get them back
+as one bundle.
+
+REAL-TIME EXAMPLES:
+- QUIC / HTTP/3 servers (quiche, msquic, ngtcp2)
+- WireGuard and VPN tunnels
+- StatsD / metrics and telemetry collectors
+- Media streaming (RTP) servers
+
+=================================================================
+*/
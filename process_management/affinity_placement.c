@@ -0,0 +1,580 @@
+/*
+=================================================================
+CPU AFFINITY + NUMA PLACEMENT OF FORKED WORKERS (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How forked workers are pinned to CPUs with sched_setaffinity()
+2. How CPU topology is read from /sys (cores, packages, nodes)
+3. Three placement policies: compact, scatter, one per core
+4. How worker memory is bound to its NUMA node
+   with set_mempolicy() and mbind()
+5. How the program degrades on single-node machines
+6. How locality is measured (sweep time, CPU migrations)
+
+DEFINITION:
+CPU affinity is the set of CPUs a process is allowed to
+run on. By default the scheduler may move a process
+between CPUs at any time, which throws away its warm
+caches. Pinning each worker to one CPU, and placing its
+memory on the NUMA node of that CPU, keeps data close
+to the core that uses it.
+
+SYNTAX (MAJOR CALLS USED):
+int sched_setaffinity(pid_t pid, size_t cpusetsize,
+                      const cpu_set_t *mask);
+int sched_getcpu(void);
+long set_mempolicy(int mode, const unsigned long *nodemask,
+                   unsigned long maxnode);
+long mbind(void *addr, unsigned long len, int mode,
+           const unsigned long *nodemask,
+           unsigned long maxnode, unsigned int flags);
+
+SYNTAX EXPLANATION:
+cpu_set_t         -> Bit mask of CPUs (CPU_ZERO, CPU_SET)
+pid 0             -> "the calling process"
+
+MPOL_BIND         -> Allocate memory ONLY from nodes in nodemask
+nodemask          -> Bit mask of NUMA nodes
+maxnode           -> Number of bits in nodemask
+
+/sys/devices/system/cpu/cpuN/topology/core_id
+                  -> Physical core number of CPU N
+/sys/devices/system/cpu/cpuN/topology/physical_package_id
+                  -> Socket (package) of CPU N
+/sys/devices/system/node/nodeK/cpulist
+                  -> CPUs that belong to NUMA node K
+
+KEY POINTS:
+- Pinning is done in the child right after fork()
+- compact: fill one core / node before using the next
+- scatter: spread workers across nodes and cores first
+- core: use only the first hardware thread of each core
+- Memory policy is set BEFORE the buffer is first touched
+- mbind()/set_mempolicy() are skipped when only one node exists
+- Raw syscalls are used, so no libnuma is needed
+
+WHY AFFINITY AND NUMA PLACEMENT?
+- Keeps caches and TLBs warm for pinned pipelines
+- Avoids slow remote-node memory access
+- Makes benchmark results repeatable
+
+IMPORTANT APIs:
+fork()              -> Create worker
+sched_setaffinity() -> Pin worker to a CPU
+sched_getcpu()      -> Check where the worker runs
+set_mempolicy()     -> Default memory policy for the worker
+mbind()             -> Memory policy for one buffer
+waitpid()           -> Reap workers
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Reads allowed CPUs and their topology from /sys
+STEP 2: Builds a CPU order for each placement policy
+STEP 3: For each policy, forks N workers
+STEP 4: Each worker pins itself and binds its memory
+STEP 5: Each worker sweeps a private buffer many times
+STEP 6: Workers report sweep time and migrations via a pipe
+STEP 7: Prints a comparison table of all policies
+
+COMPILE:
+gcc affinity_placement.c
+./a.out [workers]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Detected CPUs, cores, packages and NUMA nodes
+2. For none/compact/scatter/core:
+   average and worst sweep time, CPU migrations
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>       // For printf(), perror(), fopen()
+#include <stdlib.h>      // For malloc(), qsort(), atoi()
+#include <string.h>      // For memset(), strcmp()
+#include <sched.h>       // For sched_setaffinity(), sched_getcpu()
+#include <time.h>        // For clock_gettime()
+#include <unistd.h>      // For fork(), pipe(), read(), write()
+#include <sys/mman.h>    // For mmap()
+#include <sys/syscall.h> // For SYS_mbind, SYS_set_mempolicy
+#include <sys/types.h>   // For pid_t
+#include <sys/wait.h>    // For waitpid()
+
+#ifndef MPOL_BIND
+#define MPOL_DEFAULT 0
+#define MPOL_BIND    2
+#endif
+
+#define MAX_CPUS     1024
+#define MAX_NODES    64
+#define BUFFER_SIZE  (8 * 1024 * 1024)
+#define SWEEPS       40
+
+/*
+Topology of one allowed CPU.
+*/
+struct cpu_info
+{
+    int cpu;
+    int core;
+    int package;
+    int node;
+    int sibling_rank;   /* 0 for first thread of a core */
+    int core_rank;      /* index of its core inside its node */
+};
+
+/*
+Result sent from a worker to the parent.
+*/
+struct worker_result
+{
+    double sweep_ms;
+    int    migrations;
+    int    last_cpu;
+};
+
+enum policy { POLICY_NONE, POLICY_COMPACT, POLICY_SCATTER, POLICY_CORE };
+
+static const char *policy_names[] = { "none", "compact", "scatter", "core" };
+
+static struct cpu_info cpus[MAX_CPUS];
+static int cpu_count;
+static int node_count = 1;
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+READ ONE INTEGER FROM A SYSFS FILE
+-----------------------------------------------------------------
+Returns fallback if the file does not exist.
+*/
+static int read_sysfs_int(const char *path, int fallback)
+{
+    FILE *fp = fopen(path, "r");
+    int value = fallback;
+
+    if (fp != NULL)
+    {
+        if (fscanf(fp, "%d", &value) != 1)
+        {
+            value = fallback;
+        }
+        fclose(fp);
+    }
+
+    return value;
+}
+
+/*
+-----------------------------------------------------------------
+PARSE A CPU LIST ("0-3,8-11") INTO A cpu_set_t
+-----------------------------------------------------------------
+*/
+static int parse_cpulist(const char *path, cpu_set_t *set)
+{
+    FILE *fp = fopen(path, "r");
+    char line[4096];
+
+    CPU_ZERO(set);
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    if (fgets(line, sizeof(line), fp) == NULL)
+    {
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    for (char *tok = strtok(line, ",\n"); tok != NULL; tok = strtok(NULL, ",\n"))
+    {
+        int lo, hi;
+
+        if (sscanf(tok, "%d-%d", &lo, &hi) != 2)
+        {
+            hi = lo = atoi(tok);
+        }
+        for (int c = lo; c <= hi && c < CPU_SETSIZE; c++)
+        {
+            CPU_SET(c, set);
+        }
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+SORT ORDERS
+-----------------------------------------------------------------
+compact: node, package, core, cpu
+scatter: sibling rank, core rank, node
+*/
+static int cmp_compact(const void *a, const void *b)
+{
+    const struct cpu_info *x = a, *y = b;
+
+    if (x->node != y->node) return x->node - y->node;
+    if (x->package != y->package) return x->package - y->package;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+static int cmp_scatter(const void *a, const void *b)
+{
+    const struct cpu_info *x = a, *y = b;
+
+    if (x->sibling_rank != y->sibling_rank) return x->sibling_rank - y->sibling_rank;
+    if (x->core_rank != y->core_rank) return x->core_rank - y->core_rank;
+    if (x->node != y->node) return x->node - y->node;
+    return x->cpu - y->cpu;
+}
+
+/*
+-----------------------------------------------------------------
+DISCOVER TOPOLOGY OF ALLOWED CPUS
+-----------------------------------------------------------------
+*/
+static int discover_topology(void)
+{
+    cpu_set_t allowed, node_cpus[MAX_NODES];
+    char path[256];
+    int nodes_found = 0;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1)
+    {
+        return -1;
+    }
+
+    for (int n = 0; n < MAX_NODES; n++)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", n);
+        if (parse_cpulist(path, &node_cpus[n]) == 0)
+        {
+            nodes_found = n + 1;
+        }
+    }
+    node_count = nodes_found > 0 ? nodes_found : 1;
+
+    for (int c = 0; c < CPU_SETSIZE && cpu_count < MAX_CPUS; c++)
+    {
+        struct cpu_info *info;
+
+        if (!CPU_ISSET(c, &allowed))
+        {
+            continue;
+        }
+        info = &cpus[cpu_count++];
+        info->cpu = c;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", c);
+        info->core = read_sysfs_int(path, c);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", c);
+        info->package = read_sysfs_int(path, 0);
+
+        info->node = 0;
+        for (int n = 0; n < nodes_found; n++)
+        {
+            if (CPU_ISSET(c, &node_cpus[n]))
+            {
+                info->node = n;
+            }
+        }
+    }
+
+    /* Ranks are counted on the compact order */
+    qsort(cpus, cpu_count, sizeof(cpus[0]), cmp_compact);
+    for (int i = 0; i < cpu_count; i++)
+    {
+        struct cpu_info *prev = i > 0 ? &cpus[i - 1] : NULL;
+        int same_node = prev && prev->node == cpus[i].node;
+        int same_core = same_node && prev->package == cpus[i].package && prev->core == cpus[i].core;
+
+        cpus[i].sibling_rank = same_core ? prev->sibling_rank + 1 : 0;
+        if (same_core)
+        {
+            cpus[i].core_rank = prev->core_rank;
+        }
+        else
+        {
+            cpus[i].core_rank = same_node ? prev->core_rank + 1 : 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+BUILD CPU ORDER FOR A POLICY
+-----------------------------------------------------------------
+Returns number of entries in order[].
+*/
+static int build_order(enum policy policy, struct cpu_info *order)
+{
+    int n = 0;
+
+    for (int i = 0; i < cpu_count; i++)
+    {
+        if (policy != POLICY_CORE || cpus[i].sibling_rank == 0)
+        {
+            order[n++] = cpus[i];
+        }
+    }
+
+    if (policy == POLICY_SCATTER)
+    {
+        qsort(order, n, sizeof(order[0]), cmp_scatter);
+    }
+
+    return n;
+}
+
+/*
+-----------------------------------------------------------------
+PLACE THE CALLING WORKER
+-----------------------------------------------------------------
+Pins to one CPU and, on NUMA machines, restricts memory to
+the CPU's node. On a single node memory binding is skipped.
+*/
+static void place_worker(const struct cpu_info *target, void *buf, size_t len)
+{
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(target->cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == -1)
+    {
+        perror("sched_setaffinity failed");
+    }
+
+    if (node_count > 1)
+    {
+        unsigned long mask = 1UL << target->node;
+
+        if (syscall(SYS_set_mempolicy, MPOL_BIND, &mask, sizeof(mask) * 8) == -1)
+        {
+            perror("set_mempolicy failed");
+        }
+        if (syscall(SYS_mbind, buf, len, MPOL_BIND, &mask, sizeof(mask) * 8, 0) == -1)
+        {
+            perror("mbind failed");
+        }
+    }
+}
+
+/*
+-----------------------------------------------------------------
+WORKER BODY
+-----------------------------------------------------------------
+Sweeps a private buffer and counts CPU changes.
+*/
+static void worker(const struct cpu_info *target, int result_fd)
+{
+    struct worker_result res;
+    volatile unsigned long sink = 0;
+
+    unsigned char *buf = mmap(NULL, BUFFER_SIZE, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED)
+    {
+        _exit(1);
+    }
+
+    /* Policy first, then first touch allocates the pages */
+    if (target != NULL)
+    {
+        place_worker(target, buf, BUFFER_SIZE);
+    }
+    memset(buf, 1, BUFFER_SIZE);
+
+    memset(&res, 0, sizeof(res));
+    res.last_cpu = sched_getcpu();
+
+    double start = now_ms();
+    for (int pass = 0; pass < SWEEPS; pass++)
+    {
+        unsigned long sum = 0;
+
+        for (size_t i = 0; i < BUFFER_SIZE; i += 64)
+        {
+            sum += buf[i];
+            buf[i] = (unsigned char)sum;
+        }
+        sink += sum;
+
+        int cpu = sched_getcpu();
+        if (cpu != res.last_cpu)
+        {
+            res.migrations++;
+            res.last_cpu = cpu;
+        }
+    }
+    res.sweep_ms = now_ms() - start;
+
+    write(result_fd, &res, sizeof(res));
+    _exit(0);
+}
+
+/*
+-----------------------------------------------------------------
+RUN ONE POLICY
+-----------------------------------------------------------------
+*/
+static int run_policy(enum policy policy, int workers)
+{
+    struct cpu_info order[MAX_CPUS];
+    int slots = build_order(policy, order);
+    int fds[2];
+
+    if (pipe(fds) == -1)
+    {
+        return -1;
+    }
+
+    for (int w = 0; w < workers; w++)
+    {
+        pid_t pid = fork();
+
+        if (pid == -1)
+        {
+            return -1;
+        }
+        if (pid == 0)
+        {
+            close(fds[0]);
+            worker(policy == POLICY_NONE ? NULL : &order[w % slots], fds[1]);
+        }
+    }
+    close(fds[1]);
+
+    double total = 0, worst = 0;
+    int migrations = 0, reported = 0;
+    struct worker_result res;
+
+    while (read(fds[0], &res, sizeof(res)) == sizeof(res))
+    {
+        total += res.sweep_ms;
+        if (res.sweep_ms > worst)
+        {
+            worst = res.sweep_ms;
+        }
+        migrations += res.migrations;
+        reported++;
+    }
+    close(fds[0]);
+
+    while (waitpid(-1, NULL, 0) > 0)
+    {
+    }
+
+    printf("%-8s %8d %12.2f %12.2f %12d\n", policy_names[policy], reported,
+           reported ? total / reported : 0.0, worst, migrations);
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares unpinned workers with three
+placement policies.
+*/
+int main(int argc, char *argv[])
+{
+    /*
+    STEP 1: Discover topology
+    -------------------------
+    */
+    if (discover_topology() == -1 || cpu_count == 0)
+    {
+        perror("topology discovery failed");
+        return 1;
+    }
+
+    int workers = argc > 1 ? atoi(argv[1]) : cpu_count;
+    if (workers <= 0)
+    {
+        workers = cpu_count;
+    }
+
+    int cores = 0, packages = 0;
+    for (int i = 0; i < cpu_count; i++)
+    {
+        cores += cpus[i].sibling_rank == 0;
+        if (cpus[i].package + 1 > packages)
+        {
+            packages = cpus[i].package + 1;
+        }
+    }
+
+    printf("CPUs: %d, cores: %d, packages: %d, NUMA nodes: %d\n",
+           cpu_count, cores, packages, node_count);
+    if (node_count == 1)
+    {
+        printf("Single NUMA node: memory binding skipped\n");
+    }
+    printf("Workers: %d, buffer: %d MB, sweeps: %d\n\n", workers,
+           BUFFER_SIZE / (1024 * 1024), SWEEPS);
+
+    /*
+    STEP 2 - 7: Run every policy
+    ----------------------------
+    */
+    printf("%-8s %8s %12s %12s %12s\n", "policy", "workers", "avg ms", "worst ms", "migrations");
+    for (int p = POLICY_NONE; p <= POLICY_CORE; p++)
+    {
+        fflush(stdout);
+        if (run_policy((enum policy)p, workers) == -1)
+        {
+            perror("run failed");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. sched_setaffinity(0, ...) pins the calling process
+2. Topology comes from /sys/devices/system/cpu and /node
+3. compact = fill nearby CPUs first
+4. scatter = spread over nodes and cores first
+5. core = one worker per physical core
+6. set_mempolicy()/mbind() with MPOL_BIND keep memory local
+7. Set memory policy before first touch of the buffer
+8. Skip NUMA calls when only one node exists
+
+DEFINITION (IN SIMPLE WORDS):
+Pinning tells the kernel "run this worker only on
+this CPU, and give it memory close to that CPU",
+so its data stays in fast, nearby caches.
+
+REAL-TIME EXAMPLES:
+- Packet processing pipelines (DPDK style)
+- Databases with per-core worker threads
+- HPC jobs (numactl, taskset)
+- Low-latency trading systems
+
+=================================================================
+*/
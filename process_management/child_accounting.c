@@ -0,0 +1,468 @@
+/*
+=================================================================
+PER-CHILD RESOURCE ACCOUNTING – PROCESS MANAGEMENT (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to measure what a spawned child cost
+2. How wait4() returns rusage (CPU, max RSS, faults, switches)
+3. How perf_event_open() counts software events for a child
+4. How counting starts BEFORE exec() and runs until exit
+5. How results are aggregated into a per-command report
+6. How two reports are compared between builds
+
+DEFINITION:
+Resource accounting records the CPU time, memory and
+scheduler activity used by each child process. The kernel
+keeps these numbers for us: wait4() hands them over when
+the child is reaped, and perf_event_open() attaches
+counters to the child while it runs.
+
+SYNTAX (MAJOR CALLS USED):
+pid_t wait4(pid_t pid, int *status, int options,
+            struct rusage *rusage);
+int   perf_event_open(struct perf_event_attr *attr, pid_t pid,
+                      int cpu, int group_fd, unsigned long flags);
+int   ioctl(int fd, PERF_EVENT_IOC_ENABLE, 0);
+
+SYNTAX EXPLANATION:
+struct rusage     -> ru_utime / ru_stime : user / system CPU time
+                     ru_maxrss           : peak resident memory (KB)
+                     ru_minflt/ru_majflt : minor / major faults
+                     ru_nvcsw/ru_nivcsw  : voluntary / involuntary
+                                           context switches
+
+perf_event_attr   -> type   = PERF_TYPE_SOFTWARE
+                     config = TASK_CLOCK, PAGE_FAULTS,
+                              CPU_MIGRATIONS
+                     disabled = 1   start stopped
+                     inherit  = 1   also count grandchildren
+
+pid = child       -> Count only for that child
+cpu = -1          -> On whichever CPU it runs
+
+KEY POINTS:
+- Child waits on a pipe until the counters are attached
+- Counters are enabled, then the child is released to exec()
+- Counter fds stay readable after the child exits
+- perf_event_open() is called through syscall()
+- If perf is not allowed, counters show "-" and rusage
+  is still reported
+- Report is TSV: easy to store, sort and diff
+
+WHY PER-CHILD ACCOUNTING?
+- fork()/exec() flows say nothing about cost by default
+- Catch regressions (more faults, more CPU) between builds
+- Compare commands fairly with repeated runs
+
+IMPORTANT APIs:
+fork()            -> Create child
+perf_event_open() -> Attach software counters to child
+ioctl()           -> Enable counters
+execl()           -> Run command
+wait4()           -> Reap child + rusage
+read()            -> Read counter value
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Reads commands from arguments (or uses defaults)
+STEP 2: fork() child; child blocks on a pipe
+STEP 3: Parent opens task-clock, page-faults, cpu-migrations
+STEP 4: Parent enables counters and releases the child
+STEP 5: Child exec()s "/bin/sh -c command"
+STEP 6: wait4() reaps the child and returns rusage
+STEP 7: Counters are read and closed
+STEP 8: Runs are averaged into a TSV report per command
+STEP 9: With -c, the report is compared to a baseline
+
+COMPILE:
+gcc child_accounting.c
+./a.out [-r runs] [-o report.tsv] [-c baseline.tsv] [command ...]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. TSV report: one line per command with averaged metrics
+2. With -c: percentage change of every metric
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>               // For printf(), fprintf(), fopen()
+#include <stdlib.h>              // For atoi(), strtod()
+#include <string.h>              // For memset(), strcmp(), strchr()
+#include <unistd.h>              // For fork(), pipe(), execl(), syscall()
+#include <linux/perf_event.h>    // For struct perf_event_attr
+#include <sys/ioctl.h>           // For ioctl()
+#include <sys/resource.h>        // For struct rusage
+#include <sys/syscall.h>         // For SYS_perf_event_open
+#include <sys/types.h>           // For pid_t
+#include <sys/wait.h>            // For wait4()
+
+#define COUNTERS    3
+#define METRICS     10
+#define MAX_LINE    4096
+
+static const unsigned long long counter_configs[COUNTERS] =
+{
+    PERF_COUNT_SW_TASK_CLOCK,
+    PERF_COUNT_SW_PAGE_FAULTS,
+    PERF_COUNT_SW_CPU_MIGRATIONS,
+};
+
+static const char *metric_names[METRICS] =
+{
+    "user_ms", "sys_ms", "maxrss_kb", "minflt", "majflt",
+    "nvcsw", "nivcsw", "task_clock_ms", "page_faults", "cpu_migrations",
+};
+
+/*
+Averaged metrics of one command. Negative = not available.
+*/
+struct command_stats
+{
+    const char *cmd;
+    double      metric[METRICS];
+};
+
+/*
+-----------------------------------------------------------------
+OPEN ONE SOFTWARE COUNTER FOR A CHILD
+-----------------------------------------------------------------
+*/
+static int open_counter(pid_t pid, unsigned long long config)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0);
+}
+
+/*
+-----------------------------------------------------------------
+RUN ONE COMMAND ONCE AND ACCOUNT FOR IT
+-----------------------------------------------------------------
+metric[] receives one sample of every metric.
+*/
+static int run_once(const char *cmd, double metric[METRICS])
+{
+    int gate[2];
+    int counters[COUNTERS];
+    struct rusage ru;
+    int status;
+
+    if (pipe(gate) == -1)
+    {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        return -1;
+    }
+    if (pid == 0)
+    {
+        /* CHILD: wait until counters are attached */
+        char go;
+
+        close(gate[1]);
+        if (read(gate[0], &go, 1) != 1)
+        {
+            _exit(126);
+        }
+        close(gate[0]);
+
+        execl("/bin/sh", "sh", "-c", cmd, (char *)NULL);
+        _exit(127);
+    }
+
+    /* PARENT: attach and enable counters, then release child */
+    close(gate[0]);
+    for (int i = 0; i < COUNTERS; i++)
+    {
+        counters[i] = open_counter(pid, counter_configs[i]);
+        if (counters[i] != -1)
+        {
+            ioctl(counters[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    write(gate[1], "g", 1);
+    close(gate[1]);
+
+    if (wait4(pid, &status, 0, &ru) == -1)
+    {
+        return -1;
+    }
+
+    metric[0] = ru.ru_utime.tv_sec * 1e3 + ru.ru_utime.tv_usec / 1e3;
+    metric[1] = ru.ru_stime.tv_sec * 1e3 + ru.ru_stime.tv_usec / 1e3;
+    metric[2] = ru.ru_maxrss;
+    metric[3] = ru.ru_minflt;
+    metric[4] = ru.ru_majflt;
+    metric[5] = ru.ru_nvcsw;
+    metric[6] = ru.ru_nivcsw;
+
+    for (int i = 0; i < COUNTERS; i++)
+    {
+        unsigned long long value;
+
+        metric[7 + i] = -1;
+        if (counters[i] == -1)
+        {
+            continue;
+        }
+        if (read(counters[i], &value, sizeof(value)) == sizeof(value))
+        {
+            /* task-clock is in nanoseconds */
+            metric[7 + i] = i == 0 ? value / 1e6 : (double)value;
+        }
+        close(counters[i]);
+    }
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+/*
+-----------------------------------------------------------------
+PRINT TSV REPORT
+-----------------------------------------------------------------
+*/
+static void print_report(FILE *fp, const struct command_stats *stats, int count)
+{
+    fprintf(fp, "command");
+    for (int m = 0; m < METRICS; m++)
+    {
+        fprintf(fp, "\t%s", metric_names[m]);
+    }
+    fprintf(fp, "\n");
+
+    for (int c = 0; c < count; c++)
+    {
+        fprintf(fp, "%s", stats[c].cmd);
+        for (int m = 0; m < METRICS; m++)
+        {
+            if (stats[c].metric[m] < 0)
+            {
+                fprintf(fp, "\t-");
+            }
+            else
+            {
+                fprintf(fp, "\t%.2f", stats[c].metric[m]);
+            }
+        }
+        fprintf(fp, "\n");
+    }
+}
+
+/*
+-----------------------------------------------------------------
+COMPARE WITH A BASELINE REPORT
+-----------------------------------------------------------------
+Matches commands by name and prints percentage change.
+*/
+static int compare_report(const char *path, const struct command_stats *stats, int count)
+{
+    FILE *fp = fopen(path, "r");
+    char line[MAX_LINE];
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    printf("\nChange vs %s:\n", path);
+    printf("%-30s", "command");
+    for (int m = 0; m < METRICS; m++)
+    {
+        printf(" %14s", metric_names[m]);
+    }
+    printf("\n");
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        char *tab = strchr(line, '\t');
+
+        if (tab == NULL || strncmp(line, "command\t", 8) == 0)
+        {
+            continue;
+        }
+        *tab = '\0';
+
+        for (int c = 0; c < count; c++)
+        {
+            char *p = tab + 1;
+
+            if (strcmp(line, stats[c].cmd) != 0)
+            {
+                continue;
+            }
+
+            printf("%-30.30s", stats[c].cmd);
+            for (int m = 0; m < METRICS; m++)
+            {
+                char *end;
+                double old = strtod(p, &end);
+                double now = stats[c].metric[m];
+
+                if (end == p || now < 0 || old <= 0)
+                {
+                    printf(" %14s", "-");
+                }
+                else
+                {
+                    printf(" %+13.1f%%", (now - old) / old * 100.0);
+                }
+
+                p = strchr(p, '\t');
+                if (p == NULL)
+                {
+                    break;
+                }
+                p++;
+            }
+            printf("\n");
+        }
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program accounts the cost of every spawned child.
+*/
+int main(int argc, char *argv[])
+{
+    static const char *defaults[] =
+    {
+        "/bin/echo 'Child executed exec()'",
+        "/bin/ls -l / >/dev/null",
+        "seq 1 200000 >/dev/null",
+    };
+    const char *report_path = NULL, *baseline_path = NULL;
+    int runs = 5, opt;
+
+    while ((opt = getopt(argc, argv, "r:o:c:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': runs = atoi(optarg); break;
+        case 'o': report_path = optarg; break;
+        case 'c': baseline_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-r runs] [-o report.tsv] [-c baseline.tsv] [command ...]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (runs <= 0)
+    {
+        runs = 1;
+    }
+
+    /*
+    STEP 1: Collect commands
+    ------------------------
+    */
+    const char **cmds = optind < argc ? (const char **)&argv[optind] : defaults;
+    int count = optind < argc ? argc - optind : (int)(sizeof(defaults) / sizeof(defaults[0]));
+    struct command_stats stats[count];
+
+    /*
+    STEP 2 - 8: Run every command, average the samples
+    --------------------------------------------------
+    */
+    for (int c = 0; c < count; c++)
+    {
+        stats[c].cmd = cmds[c];
+        memset(stats[c].metric, 0, sizeof(stats[c].metric));
+
+        for (int r = 0; r < runs; r++)
+        {
+            double sample[METRICS];
+
+            fflush(stdout);
+            if (run_once(cmds[c], sample) == -1)
+            {
+                perror("run failed");
+                return 1;
+            }
+            for (int m = 0; m < METRICS; m++)
+            {
+                /* A metric missing once stays missing */
+                if (sample[m] < 0 || stats[c].metric[m] < 0)
+                {
+                    stats[c].metric[m] = -1;
+                }
+                else
+                {
+                    stats[c].metric[m] += sample[m] / runs;
+                }
+            }
+        }
+    }
+
+    print_report(stdout, stats, count);
+
+    if (report_path != NULL)
+    {
+        FILE *fp = fopen(report_path, "w");
+
+        if (fp == NULL)
+        {
+            perror("fopen failed");
+            return 1;
+        }
+        print_report(fp, stats, count);
+        fclose(fp);
+    }
+
+    /*
+    STEP 9: Compare with a previous build
+    -------------------------------------
+    */
+    if (baseline_path != NULL && compare_report(baseline_path, stats, count) == -1)
+    {
+        perror("baseline open failed");
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. wait4() = waitpid() + struct rusage of the child
+2. rusage: CPU time, max RSS, faults, context switches
+3. perf_event_open(pid = child) attaches a counter to it
+4. Software events: task-clock, page-faults, cpu-migrations
+5. Child waits on a pipe so counting starts before exec()
+6. inherit = 1 also counts processes the child creates
+7. TSV report + baseline compare = regression check
+
+DEFINITION (IN SIMPLE WORDS):
+The parent writes down how much CPU, memory and
+scheduling each child used, so two builds can be
+compared number by number.
+
+REAL-TIME EXAMPLES:
+- /usr/bin/time -v and perf stat
+- CI performance regression checks
+- Batch job billing
+- Build system profiling
+
+=================================================================
+*/
@@ -0,0 +1,407 @@
+/*
+=================================================================
+COPY-ON-WRITE PARALLEL SCAN WITH fork() + mmap() (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How one mmap() of a large file is shared by forked children
+2. How fork() gives parallelism without copying the data
+3. How each child scans a disjoint range of the mapping
+4. How partial results return over socketpair() for reduction
+5. How scan time scales from 1 to N children
+6. How RSS shows the pages are shared, not copied
+
+DEFINITION:
+After fork() the child sees the same memory as the parent.
+Pages are only copied when one side WRITES to them
+(copy-on-write). A read-only file mapping is never written,
+so every child reads the very same page-cache pages: the
+data is loaded once, no matter how many children scan it.
+
+SYNTAX (MAJOR CALLS USED):
+void *mmap(void *addr, size_t length, int prot, int flags,
+           int fd, off_t offset);
+int   madvise(void *addr, size_t length, int advice);
+pid_t fork(void);
+int   socketpair(int domain, int type, int protocol, int sv[2]);
+
+SYNTAX EXPLANATION:
+PROT_READ         -> Mapping is read-only
+MAP_SHARED        -> Mapping is backed by the page cache
+MADV_SEQUENTIAL   -> Kernel reads ahead aggressively
+
+RssFile           -> Resident file pages (shared page cache)
+RssAnon           -> Resident private pages (would grow if
+                     the data were copied)
+
+KEY POINTS:
+- Parent maps the file ONCE before forking
+- Children inherit the mapping, no extra open()/read()
+- Ranges are disjoint; no locking is needed
+- Each child sends one small struct back over its socket
+- Parent adds up the partial results (reduction)
+- RssAnon of each child stays tiny: nothing is copied
+- Sum of RssFile equals the file size for every N
+
+WHY FORK + MMAP?
+- Simple process-level parallelism
+- No data copies and no shared-memory setup
+- A crashing child cannot corrupt the others
+
+IMPORTANT APIs:
+open()        -> Open input file
+mmap()        -> Map whole file read-only
+fork()        -> Create scanning children
+socketpair()  -> Return partial result to parent
+waitpid()     -> Reap children
+munmap()      -> Release mapping
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Creates the input file if it does not exist
+STEP 2: open() + mmap() the whole file once
+STEP 3: Warm-up scan so the page cache is hot
+STEP 4: For N = 1, 2, 4, ... forks N children
+STEP 5: Child i counts lines and bytes in range i
+STEP 6: Child sends partial result + its RSS via socketpair()
+STEP 7: Parent reduces partials and prints scaling + RSS
+
+COMPILE:
+gcc -O2 cow_parallel_scan.c
+./a.out [file] [size_mb_if_created] [max_children]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. File size and line count
+2. For each N: time, GB/s, speedup
+3. For each N: summed RssAnon (flat) and RssFile (file size)
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>      // For printf(), perror(), fopen()
+#include <stdlib.h>     // For atoi(), atol()
+#include <string.h>     // For memset(), strncmp()
+#include <fcntl.h>      // For open()
+#include <time.h>       // For clock_gettime()
+#include <unistd.h>     // For fork(), write(), close()
+#include <sys/mman.h>   // For mmap(), madvise(), munmap()
+#include <sys/socket.h> // For socketpair(), send(), recv()
+#include <sys/stat.h>   // For fstat()
+#include <sys/types.h>  // For pid_t
+#include <sys/wait.h>   // For waitpid()
+
+#define MAX_CHILDREN 256
+
+/*
+Partial result computed by one child.
+*/
+struct partial
+{
+    unsigned long lines;
+    unsigned long checksum;
+    long          rss_anon_kb;
+    long          rss_file_kb;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+CREATE INPUT FILE
+-----------------------------------------------------------------
+Writes text lines until the file has size_mb megabytes.
+*/
+static int create_input(const char *path, long size_mb)
+{
+    static char chunk[1024 * 1024];
+    size_t used = 0;
+    unsigned long line = 0;
+
+    int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    while (used < sizeof(chunk) - 64)
+    {
+        used += snprintf(chunk + used, sizeof(chunk) - used,
+                         "record %lu value %lu\n", line, line * 2654435761UL % 100000);
+        line++;
+    }
+
+    for (long i = 0; i < size_mb; i++)
+    {
+        if (write(fd, chunk, used) != (ssize_t)used)
+        {
+            close(fd);
+            return -1;
+        }
+    }
+
+    close(fd);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+SCAN ONE RANGE
+-----------------------------------------------------------------
+Counts newlines and sums bytes. Only reads the mapping.
+*/
+static void scan_range(const unsigned char *data, size_t begin, size_t end, struct partial *p)
+{
+    unsigned long lines = 0, sum = 0;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        lines += data[i] == '\n';
+        sum += data[i];
+    }
+
+    p->lines = lines;
+    p->checksum = sum;
+}
+
+/*
+-----------------------------------------------------------------
+READ RssAnon / RssFile OF THIS PROCESS
+-----------------------------------------------------------------
+*/
+static void read_rss(long *anon_kb, long *file_kb)
+{
+    FILE *fp = fopen("/proc/self/status", "r");
+    char line[256];
+
+    *anon_kb = *file_kb = -1;
+    if (fp == NULL)
+    {
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (strncmp(line, "RssAnon:", 8) == 0)
+        {
+            sscanf(line + 8, "%ld", anon_kb);
+        }
+        else if (strncmp(line, "RssFile:", 8) == 0)
+        {
+            sscanf(line + 8, "%ld", file_kb);
+        }
+    }
+    fclose(fp);
+}
+
+/*
+-----------------------------------------------------------------
+PARALLEL SCAN WITH N CHILDREN
+-----------------------------------------------------------------
+*/
+static int parallel_scan(const unsigned char *data, size_t size, int n, struct partial *total)
+{
+    int socks[MAX_CHILDREN];
+
+    memset(total, 0, sizeof(*total));
+
+    for (int i = 0; i < n; i++)
+    {
+        int sv[2];
+
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+        {
+            return -1;
+        }
+
+        pid_t pid = fork();
+        if (pid == -1)
+        {
+            return -1;
+        }
+        if (pid == 0)
+        {
+            /* CHILD: scan range i of the inherited mapping */
+            struct partial p;
+            size_t begin = size / n * i;
+            size_t end = i == n - 1 ? size : size / n * (i + 1);
+
+            close(sv[0]);
+            scan_range(data, begin, end, &p);
+            read_rss(&p.rss_anon_kb, &p.rss_file_kb);
+            send(sv[1], &p, sizeof(p), 0);
+            _exit(0);
+        }
+
+        close(sv[1]);
+        socks[i] = sv[0];
+    }
+
+    /* PARENT: reduce partial results */
+    for (int i = 0; i < n; i++)
+    {
+        struct partial p;
+
+        if (recv(socks[i], &p, sizeof(p), MSG_WAITALL) != sizeof(p))
+        {
+            return -1;
+        }
+        close(socks[i]);
+
+        total->lines += p.lines;
+        total->checksum += p.checksum;
+        total->rss_anon_kb += p.rss_anon_kb;
+        total->rss_file_kb += p.rss_file_kb;
+    }
+
+    while (waitpid(-1, NULL, 0) > 0)
+    {
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program scans one shared mapping with 1..N children.
+*/
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 1 ? argv[1] : "x.txt";
+    long size_mb = argc > 2 ? atol(argv[2]) : 1024;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_children = argc > 3 ? atoi(argv[3]) : (cores > 4 ? cores : 4);
+    struct stat st;
+
+    if (max_children <= 0 || max_children > MAX_CHILDREN)
+    {
+        max_children = MAX_CHILDREN;
+    }
+
+    /*
+    STEP 1: Create input file if needed
+    -----------------------------------
+    */
+    if (access(path, F_OK) == -1)
+    {
+        printf("Creating %s (%ld MB)...\n", path, size_mb);
+        if (create_input(path, size_mb) == -1)
+        {
+            perror("create failed");
+            return 1;
+        }
+    }
+
+    /*
+    STEP 2: Map the whole file once
+    -------------------------------
+    */
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        perror("open failed");
+        return 1;
+    }
+    if (fstat(fd, &st) == -1 || st.st_size == 0)
+    {
+        fprintf(stderr, "empty or unreadable file\n");
+        close(fd);
+        return 1;
+    }
+
+    size_t size = st.st_size;
+    const unsigned char *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        perror("mmap failed");
+        close(fd);
+        return 1;
+    }
+    close(fd);
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    /*
+    STEP 3: Warm-up scan
+    --------------------
+    */
+    struct partial ref;
+    scan_range(data, 0, size, &ref);
+    printf("File: %s, %.1f MB, %lu lines\n\n", path, size / 1048576.0, ref.lines);
+
+    /*
+    STEP 4 - 7: Scale from 1 to N children
+    --------------------------------------
+    */
+    printf("%9s %10s %8s %9s %14s %14s\n", "children", "ms", "GB/s", "speedup",
+           "sum RssAnon", "sum RssFile");
+
+    double base = 0;
+    for (int n = 1; n <= max_children; n *= 2)
+    {
+        struct partial total;
+        double start = now_ms();
+
+        if (parallel_scan(data, size, n, &total) == -1)
+        {
+            perror("parallel scan failed");
+            return 1;
+        }
+        double ms = now_ms() - start;
+
+        if (total.lines != ref.lines || total.checksum != ref.checksum)
+        {
+            fprintf(stderr, "reduction mismatch with %d children\n", n);
+            return 1;
+        }
+        if (n == 1)
+        {
+            base = ms;
+        }
+
+        printf("%9d %10.1f %8.2f %8.2fx %11ld KB %11ld KB\n", n, ms,
+               size / (ms / 1e3) / 1e9, base / ms, total.rss_anon_kb, total.rss_file_kb);
+    }
+
+    munmap((void *)data, size);
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. mmap() the file once, then fork()
+2. Children inherit the mapping (same physical pages)
+3. Read-only pages are never copied (copy-on-write)
+4. Disjoint ranges need no locks
+5. socketpair() returns each partial result
+6. Parent reduces: total = sum of partials
+7. RssAnon stays flat; RssFile is the shared page cache
+
+DEFINITION (IN SIMPLE WORDS):
+The parent opens a big file as memory once, and
+several children each read their own slice of it,
+all looking at the same copy of the data.
+
+REAL-TIME EXAMPLES:
+- Log and data file analysis
+- Pre-fork servers sharing read-only data
+- Database read-only snapshot scans
+- Genome / scientific data processing
+
+=================================================================
+*/
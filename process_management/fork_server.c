@@ -0,0 +1,528 @@
+/*
+=================================================================
+FORK SERVER (ZYGOTE) – PROCESS MANAGEMENT (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. What a fork server (zygote) is
+2. How a worker image is initialized only once
+3. How warmed copies are created with fork() on request
+4. How stdio file descriptors are passed with SCM_RIGHTS
+5. How much launch latency is saved compared with exec()
+
+DEFINITION:
+A fork server is a long-lived process that loads and
+initializes a worker image once and then creates
+ready-to-run copies of itself with fork() whenever a
+client asks for one. The copies skip program loading,
+dynamic linking and initialization because they inherit
+the already warmed-up memory of the server.
+
+SYNTAX (MAJOR CALLS USED):
+int     socketpair(int domain, int type, int protocol, int sv[2]);
+ssize_t sendmsg(int sockfd, const struct msghdr *msg, int flags);
+ssize_t recvmsg(int sockfd, struct msghdr *msg, int flags);
+pid_t   fork(void);
+int     dup2(int oldfd, int newfd);
+pid_t   waitpid(pid_t pid, int *status, int options);
+
+SYNTAX EXPLANATION:
+struct msghdr     -> Describes the data buffer (msg_iov) and
+                     the ancillary data (msg_control)
+
+SCM_RIGHTS        -> Ancillary message type that carries
+                     open file descriptors to another process
+
+CMSG_SPACE(n)     -> Bytes needed for ancillary data of n bytes
+CMSG_FIRSTHDR()   -> First ancillary header in msg_control
+CMSG_DATA()       -> Pointer to the payload (the fd array)
+
+SOCK_SEQPACKET    -> Keeps message boundaries, so one sendmsg()
+                     is always one launch request
+
+KEY POINTS:
+- Worker initialization runs once, inside the server
+- Each launch is only fork() + dup2(), no exec()
+- The client sends its own stdin/stdout/stderr with the request
+- Received descriptors are new fds in the server process
+- The server reaps every worker and reports its exit status
+- Copy-on-write keeps forked copies cheap
+
+WHY A FORK SERVER?
+- exec() pays loading, linking and init cost every launch
+- Frequently started short-lived workers become much faster
+- Used by Android (zygote), Chrome, and test runners
+
+IMPORTANT APIs:
+socketpair() -> Channel between client and server
+sendmsg()    -> Send request + file descriptors
+recvmsg()    -> Receive request + file descriptors
+fork()       -> Create warmed-up worker copy
+dup2()       -> Install passed fds as 0, 1, 2
+waitpid()    -> Reap worker and collect status
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: socketpair() creates the client/server channel
+STEP 2: fork() starts the fork server process
+STEP 3: Server initializes the worker image once
+STEP 4: Client sends a launch request with its stdio fds
+STEP 5: Server forks a warmed worker, worker prints its args
+STEP 6: Cold launches: fork() + execl("/bin/echo") N times
+STEP 7: Warm launches: N requests to the fork server
+STEP 8: Prints per-launch latency and the time saved
+
+COMPILE:
+gcc fork_server.c
+./a.out [launches]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. One worker launched through the server prints a message
+2. Average latency of cold exec() launches
+3. Average latency of fork server launches
+4. Time saved per launch
+
+=================================================================
+*/
+
+#include <stdio.h>      // For printf(), perror()
+#include <stdlib.h>     // For malloc(), atoi()
+#include <string.h>     // For memset(), memcpy(), strlen()
+#include <fcntl.h>      // For open()
+#include <time.h>       // For clock_gettime()
+#include <unistd.h>     // For fork(), dup2(), execl(), _exit()
+#include <sys/socket.h> // For socketpair(), sendmsg(), recvmsg()
+#include <sys/types.h>  // For pid_t
+#include <sys/uio.h>    // For struct iovec
+#include <sys/wait.h>   // For waitpid()
+
+#define MAX_ARGS_BYTES  256
+#define WARM_TABLE_SIZE (4 * 1024 * 1024)
+
+/*
+Launch request sent from client to server.
+args holds argc NUL-separated strings.
+*/
+struct launch_request
+{
+    int  argc;
+    char args[MAX_ARGS_BYTES];
+};
+
+/*
+Launch reply sent from server back to client.
+*/
+struct launch_reply
+{
+    pid_t pid;
+    int   status;
+};
+
+/* State built once by the server and inherited by every worker */
+static unsigned char *warm_table;
+
+/*
+-----------------------------------------------------------------
+NOW IN MICROSECONDS
+-----------------------------------------------------------------
+*/
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/*
+-----------------------------------------------------------------
+WORKER IMAGE INITIALIZATION
+-----------------------------------------------------------------
+Stands in for the expensive start-up of a real worker
+(loading libraries, parsing config, building tables).
+It runs ONCE in the server, never in the workers.
+*/
+static int warm_up_worker(void)
+{
+    warm_table = malloc(WARM_TABLE_SIZE);
+    if (warm_table == NULL)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < WARM_TABLE_SIZE; i++)
+    {
+        warm_table[i] = (unsigned char)(i * 31 + 7);
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+WORKER ENTRY POINT
+-----------------------------------------------------------------
+Runs inside the forked copy. Behaves like /bin/echo:
+prints its arguments separated by spaces on stdout.
+*/
+static int worker_main(int argc, char *argv[])
+{
+    char line[MAX_ARGS_BYTES + 1];
+    size_t used = 0;
+
+    for (int i = 0; i < argc; i++)
+    {
+        size_t n = strlen(argv[i]);
+
+        if (i > 0)
+        {
+            line[used++] = ' ';
+        }
+        memcpy(line + used, argv[i], n);
+        used += n;
+    }
+    line[used++] = '\n';
+
+    return write(STDOUT_FILENO, line, used) == (ssize_t)used ? 0 : 1;
+}
+
+/*
+-----------------------------------------------------------------
+SEND REQUEST WITH FILE DESCRIPTORS
+-----------------------------------------------------------------
+The fds travel as SCM_RIGHTS ancillary data next to the
+request bytes.
+*/
+static int send_request(int sock, const struct launch_request *req, const int fds[3])
+{
+    struct iovec iov = { (void *)req, sizeof(*req) };
+    char control[CMSG_SPACE(3 * sizeof(int))];
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(3 * sizeof(int));
+    memcpy(CMSG_DATA(cmsg), fds, 3 * sizeof(int));
+
+    return sendmsg(sock, &msg, 0) == -1 ? -1 : 0;
+}
+
+/*
+-----------------------------------------------------------------
+RECEIVE REQUEST WITH FILE DESCRIPTORS
+-----------------------------------------------------------------
+Returns 1 on request, 0 when the client has gone away,
+-1 on error.
+*/
+static int recv_request(int sock, struct launch_request *req, int fds[3])
+{
+    struct iovec iov = { req, sizeof(*req) };
+    char control[CMSG_SPACE(3 * sizeof(int))];
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if (n <= 0)
+    {
+        return (int)n;
+    }
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (n != sizeof(*req) || cmsg == NULL || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(3 * sizeof(int)))
+    {
+        return -1;
+    }
+    memcpy(fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+
+    return 1;
+}
+
+/*
+-----------------------------------------------------------------
+FORK SERVER LOOP
+-----------------------------------------------------------------
+Receives requests, forks a warmed worker for each one,
+reaps it and replies with its exit status.
+*/
+static void fork_server(int sock)
+{
+    struct launch_request req;
+    int fds[3];
+
+    if (warm_up_worker() == -1)
+    {
+        perror("worker init failed");
+        _exit(1);
+    }
+
+    while (recv_request(sock, &req, fds) == 1)
+    {
+        struct launch_reply reply = { -1, -1 };
+
+        reply.pid = fork();
+        if (reply.pid == 0)
+        {
+            /* WORKER: install client stdio, then run */
+            char *argv[MAX_ARGS_BYTES / 2 + 1];
+            char *p = req.args;
+
+            close(sock);
+            for (int i = 0; i < 3; i++)
+            {
+                dup2(fds[i], i);
+            }
+
+            req.args[MAX_ARGS_BYTES - 1] = '\0';
+            if (req.argc < 0 || req.argc > MAX_ARGS_BYTES / 2)
+            {
+                _exit(2);
+            }
+            for (int i = 0; i < req.argc; i++)
+            {
+                if (p >= req.args + MAX_ARGS_BYTES)
+                {
+                    _exit(2);
+                }
+                argv[i] = p;
+                p += strlen(p) + 1;
+            }
+            argv[req.argc] = NULL;
+
+            _exit(worker_main(req.argc, argv));
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            close(fds[i]);
+        }
+
+        if (reply.pid > 0)
+        {
+            waitpid(reply.pid, &reply.status, 0);
+        }
+        send(sock, &reply, sizeof(reply), 0);
+    }
+
+    _exit(0);
+}
+
+/*
+-----------------------------------------------------------------
+LAUNCH THROUGH FORK SERVER
+-----------------------------------------------------------------
+*/
+static int warm_launch(int sock, int argc, char *argv[], const int fds[3])
+{
+    struct launch_request req;
+    struct launch_reply reply;
+    size_t used = 0;
+
+    memset(&req, 0, sizeof(req));
+    req.argc = argc;
+    for (int i = 0; i < argc; i++)
+    {
+        size_t n = strlen(argv[i]) + 1;
+
+        if (used + n > MAX_ARGS_BYTES)
+        {
+            return -1;
+        }
+        memcpy(req.args + used, argv[i], n);
+        used += n;
+    }
+
+    if (send_request(sock, &req, fds) == -1)
+    {
+        return -1;
+    }
+    if (recv(sock, &reply, sizeof(reply), 0) != sizeof(reply))
+    {
+        return -1;
+    }
+
+    return reply.status;
+}
+
+/*
+-----------------------------------------------------------------
+COLD LAUNCH WITH fork() + exec()
+-----------------------------------------------------------------
+*/
+static int cold_launch(int out_fd)
+{
+    int status = -1;
+    pid_t pid = fork();
+
+    if (pid == -1)
+    {
+        return -1;
+    }
+    if (pid == 0)
+    {
+        dup2(out_fd, STDOUT_FILENO);
+        execl("/bin/echo", "echo", "worker", "launched", NULL);
+        _exit(127);
+    }
+
+    waitpid(pid, &status, 0);
+    return status;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program compares cold exec() launches with launches
+through a warmed-up fork server.
+*/
+int main(int argc, char *argv[])
+{
+    int launches = argc > 1 ? atoi(argv[1]) : 200;
+    char *worker_args[] = { "worker", "launched" };
+    char *hello_args[] = { "Hello", "from", "a", "warmed-up", "worker" };
+    int sv[2];
+
+    if (launches <= 0)
+    {
+        launches = 200;
+    }
+
+    /*
+    STEP 1: Create client/server channel
+    ------------------------------------
+    SOCK_SEQPACKET -> one message per request
+    */
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) == -1)
+    {
+        perror("socketpair failed");
+        return 1;
+    }
+
+    /*
+    STEP 2 + 3: Start fork server (initializes once)
+    ------------------------------------------------
+    */
+    pid_t server = fork();
+    if (server == -1)
+    {
+        perror("fork failed");
+        return 1;
+    }
+    if (server == 0)
+    {
+        close(sv[0]);
+        fork_server(sv[1]);
+    }
+    close(sv[1]);
+
+    /*
+    STEP 4 + 5: Launch one worker on our own stdio
+    ----------------------------------------------
+    */
+    int stdio_fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+
+    fflush(stdout);
+    if (warm_launch(sv[0], 5, hello_args, stdio_fds) != 0)
+    {
+        perror("warm launch failed");
+        return 1;
+    }
+
+    /* Benchmarks write to /dev/null to keep the terminal quiet */
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd == -1)
+    {
+        perror("open failed");
+        return 1;
+    }
+    int null_fds[3] = { STDIN_FILENO, null_fd, STDERR_FILENO };
+
+    /*
+    STEP 6: Cold launches (fork + exec)
+    -----------------------------------
+    */
+    double start = now_us();
+    for (int i = 0; i < launches; i++)
+    {
+        if (cold_launch(null_fd) != 0)
+        {
+            perror("cold launch failed");
+            return 1;
+        }
+    }
+    double cold_us = (now_us() - start) / launches;
+
+    /*
+    STEP 7: Warm launches (fork server)
+    -----------------------------------
+    */
+    start = now_us();
+    for (int i = 0; i < launches; i++)
+    {
+        if (warm_launch(sv[0], 2, worker_args, null_fds) != 0)
+        {
+            perror("warm launch failed");
+            return 1;
+        }
+    }
+    double warm_us = (now_us() - start) / launches;
+
+    /*
+    STEP 8: Report and shut down server
+    -----------------------------------
+    Closing our end makes recvmsg() return 0 in the server.
+    */
+    printf("Launches           : %d\n", launches);
+    printf("Cold fork + exec() : %8.1f us per launch\n", cold_us);
+    printf("Fork server        : %8.1f us per launch\n", warm_us);
+    printf("Saved              : %8.1f us per launch (%.1fx faster)\n",
+           cold_us - warm_us, cold_us / warm_us);
+
+    close(null_fd);
+    close(sv[0]);
+    waitpid(server, NULL, 0);
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Fork server initializes the worker image once
+2. Each launch is fork() of the warmed server, no exec()
+3. SCM_RIGHTS passes open fds between processes
+4. Received fds are installed with dup2() as 0, 1, 2
+5. SOCK_SEQPACKET keeps one request per message
+6. Server reaps workers and reports exit status
+7. Saves loading, linking and init cost per launch
+
+DEFINITION (IN SIMPLE WORDS):
+A fork server gets a program ready once and then
+hands out ready-made copies of it, instead of
+starting the program from scratch every time.
+
+REAL-TIME EXAMPLES:
+- Android zygote starting apps
+- Browser renderer process launchers
+- Fuzzers (AFL fork server)
+- Test runners with preloaded environments
+
+=================================================================
+*/
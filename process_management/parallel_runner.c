@@ -0,0 +1,772 @@
+/*
+=================================================================
+PARALLEL COMMAND RUNNER – PROCESS MANAGEMENT (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. How to run many commands with at most K in flight (xargs -P)
+2. How fork() + exec() are combined with pipe() redirection
+3. How stdout/stderr of all children are captured with ONE epoll
+4. How non-blocking pipes avoid stalls on slow children
+5. How output is written ordered or interleaved with writev()
+6. How per-command wall time and CPU time are measured
+
+DEFINITION:
+A parallel runner starts commands as child processes,
+keeps up to K of them running at the same time, and
+collects their output through pipes. One epoll loop
+watches every pipe and every child (pidfd), so a single
+thread can drive all children without blocking.
+
+SYNTAX (MAJOR CALLS USED):
+int     pipe2(int pipefd[2], int flags);
+pid_t   fork(void);
+int     execl(const char *path, const char *arg, ...);
+int     epoll_wait(int epfd, struct epoll_event *events,
+                   int maxevents, int timeout);
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt);
+pid_t   wait4(pid_t pid, int *status, int options,
+              struct rusage *rusage);
+
+SYNTAX EXPLANATION:
+O_NONBLOCK        -> read() returns EAGAIN instead of blocking
+O_CLOEXEC         -> fd is closed automatically on exec()
+
+struct iovec      -> { base, length } of one buffer piece
+writev()          -> Writes many buffer pieces with ONE call
+
+wait4()           -> Like waitpid() but also fills rusage
+                     (user/system CPU time of the child)
+
+KEY POINTS:
+- Each child gets two pipes: one for stdout, one for stderr
+- Parent reads pipe ends in non-blocking mode
+- A pidfd per child tells the loop when to reap it
+- Ordered mode keeps each command's output together,
+  in input order; interleaved mode writes as data arrives
+- Captured chunks are not copied again: writev() sends them
+- Job is finished when both pipes hit EOF and it is reaped
+
+WHY A PARALLEL RUNNER?
+- Use all CPU cores for independent commands
+- Keep output readable even when commands run together
+- Measure what every command cost
+
+IMPORTANT APIs:
+pipe2()       -> Create output pipes (read end non-blocking)
+fork()        -> Create child
+dup2()        -> Redirect child stdout/stderr into pipes
+execl()       -> Run "/bin/sh -c command"
+epoll_wait()  -> Wait on all pipes and pidfds
+writev()      -> Write gathered output chunks
+wait4()       -> Reap child with CPU usage
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Reads commands from stdin (one per line)
+STEP 2: Starts up to K commands with fork() + exec()
+STEP 3: epoll_wait() collects output and child exits
+STEP 4: When a job ends, another one is started
+STEP 5: Output is written with writev() (ordered/interleaved)
+STEP 6: Per-command wall time and CPU time go to stderr
+STEP 7: With -b, a built-in workload is timed for K = 1..2*cores
+
+COMPILE:
+gcc parallel_runner.c
+printf 'echo one\necho two\n' | ./a.out -P 4
+./a.out -b
+
+OPTIONS:
+-P K  -> at most K commands in flight (default: CPU count)
+-i    -> interleaved output instead of ordered output
+-q    -> do not print the per-command report
+-b    -> throughput benchmark as K scales with core count
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Output of every command
+2. Report: exit status, wall ms and CPU ms per command
+3. Overall commands per second
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), fprintf(), getline()
+#include <stdlib.h>       // For malloc(), realloc(), atoi()
+#include <string.h>       // For memcpy(), strlen(), strdup()
+#include <signal.h>       // For kill(), SIGKILL
+#include <errno.h>        // For errno, EAGAIN, EINTR
+#include <fcntl.h>        // For O_NONBLOCK, O_CLOEXEC
+#include <limits.h>       // For IOV_MAX
+#include <time.h>         // For clock_gettime()
+#include <unistd.h>       // For fork(), pipe2(), dup2(), execl()
+#include <sys/epoll.h>    // For epoll_create1(), epoll_ctl(), epoll_wait()
+#include <sys/resource.h> // For struct rusage
+#include <sys/syscall.h>  // For SYS_pidfd_open
+#include <sys/types.h>    // For pid_t
+#include <sys/uio.h>      // For writev(), struct iovec
+#include <sys/wait.h>     // For wait4(), waitpid()
+
+#define READ_CHUNK  65536
+#define MAX_EVENTS  128
+
+/* epoll tag = job index * 4 + source */
+#define SRC_STDOUT 0
+#define SRC_STDERR 1
+#define SRC_PIDFD  2
+
+/*
+Captured output of one stream, kept as separate chunks
+so that writev() can send them without copying.
+*/
+struct capture
+{
+    struct iovec *chunks;
+    int           count;
+    int           capacity;
+};
+
+/*
+One command and its runtime state.
+*/
+struct job
+{
+    char          *cmd;
+    pid_t          pid;
+    int            fds[3];   /* stdout pipe, stderr pipe, pidfd */
+    int            open;     /* sources still open */
+    int            status;
+    double         start_ms;
+    double         wall_ms;
+    struct rusage  usage;
+    struct capture out[2];
+};
+
+/*
+Runner state shared by the loop.
+*/
+struct runner
+{
+    struct job *jobs;
+    int         count;
+    int         max_inflight;
+    int         interleaved;
+    int         discard;
+    int         epfd;
+    int         next_start;
+    int         next_emit;
+    int         inflight;
+    int         finished;
+    struct capture pending[2];  /* interleaved mode, per stream */
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+APPEND CHUNK TO CAPTURE
+-----------------------------------------------------------------
+*/
+static int capture_add(struct capture *cap, const char *data, size_t len)
+{
+    if (cap->count == cap->capacity)
+    {
+        int capacity = cap->capacity ? cap->capacity * 2 : 8;
+        struct iovec *chunks = realloc(cap->chunks, capacity * sizeof(struct iovec));
+
+        if (chunks == NULL)
+        {
+            return -1;
+        }
+        cap->chunks = chunks;
+        cap->capacity = capacity;
+    }
+
+    void *copy = malloc(len);
+    if (copy == NULL)
+    {
+        return -1;
+    }
+    memcpy(copy, data, len);
+    cap->chunks[cap->count].iov_base = copy;
+    cap->chunks[cap->count].iov_len = len;
+    cap->count++;
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+WRITE ALL BYTES
+-----------------------------------------------------------------
+*/
+static int write_all(int fd, const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t w = write(fd, data, len);
+
+        if (w == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += w;
+        len -= w;
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+WRITE CAPTURE WITH writev()
+-----------------------------------------------------------------
+Sends up to IOV_MAX chunks per call, finishes a partially
+written chunk with write(), then releases the chunks.
+*/
+static int capture_flush(struct capture *cap, int fd)
+{
+    int first = 0;
+    int rc = 0;
+
+    while (first < cap->count && rc == 0)
+    {
+        int n = cap->count - first;
+        if (n > IOV_MAX)
+        {
+            n = IOV_MAX;
+        }
+
+        ssize_t w = writev(fd, cap->chunks + first, n);
+        if (w == -1)
+        {
+            if (errno != EINTR)
+            {
+                rc = -1;
+            }
+            continue;
+        }
+
+        while (w > 0)
+        {
+            struct iovec *iov = &cap->chunks[first++];
+
+            if ((size_t)w < iov->iov_len)
+            {
+                rc = write_all(fd, (char *)iov->iov_base + w, iov->iov_len - w);
+                break;
+            }
+            w -= iov->iov_len;
+        }
+    }
+
+    for (int i = 0; i < cap->count; i++)
+    {
+        free(cap->chunks[i].iov_base);
+    }
+    cap->count = 0;
+
+    return rc;
+}
+
+/*
+-----------------------------------------------------------------
+UNDO A PARTLY STARTED JOB
+-----------------------------------------------------------------
+Removes the first 'registered' sources from epoll, closes every
+fd that was opened, then kills and reaps the child so it does
+not stay a zombie. errno of the original failure is kept.
+*/
+static void job_abort(struct runner *r, struct job *job, int registered)
+{
+    int saved = errno;
+
+    for (int src = 0; src < 3; src++)
+    {
+        if (src < registered)
+        {
+            epoll_ctl(r->epfd, EPOLL_CTL_DEL, job->fds[src], NULL);
+        }
+        if (job->fds[src] != -1)
+        {
+            close(job->fds[src]);
+            job->fds[src] = -1;
+        }
+    }
+    kill(job->pid, SIGKILL);
+    waitpid(job->pid, NULL, 0);
+    errno = saved;
+}
+
+/*
+-----------------------------------------------------------------
+START ONE JOB
+-----------------------------------------------------------------
+Child: stdout/stderr -> pipes, then /bin/sh -c "cmd".
+Parent: registers both pipe read ends and a pidfd.
+*/
+static int job_start(struct runner *r, int index)
+{
+    struct job *job = &r->jobs[index];
+    int out_pipe[2], err_pipe[2];
+
+    if (pipe2(out_pipe, O_CLOEXEC) == -1)
+    {
+        return -1;
+    }
+    if (pipe2(err_pipe, O_CLOEXEC) == -1)
+    {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        return -1;
+    }
+
+    job->start_ms = now_ms();
+    job->pid = fork();
+    if (job->pid == -1)
+    {
+        int saved = errno;
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        close(err_pipe[0]);
+        close(err_pipe[1]);
+        errno = saved;
+        return -1;
+    }
+    if (job->pid == 0)
+    {
+        dup2(out_pipe[1], STDOUT_FILENO);
+        dup2(err_pipe[1], STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", job->cmd, (char *)NULL);
+        perror("exec failed");
+        _exit(127);
+    }
+
+    close(out_pipe[1]);
+    close(err_pipe[1]);
+    fcntl(out_pipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(err_pipe[0], F_SETFL, O_NONBLOCK);
+
+    job->fds[SRC_STDOUT] = out_pipe[0];
+    job->fds[SRC_STDERR] = err_pipe[0];
+    job->fds[SRC_PIDFD] = (int)syscall(SYS_pidfd_open, job->pid, 0);
+    if (job->fds[SRC_PIDFD] == -1)
+    {
+        job_abort(r, job, 0);
+        return -1;
+    }
+
+    for (int src = 0; src < 3; src++)
+    {
+        struct epoll_event ev;
+
+        ev.events = EPOLLIN;
+        ev.data.u64 = (uint64_t)index * 4 + src;
+        if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, job->fds[src], &ev) == -1)
+        {
+            job_abort(r, job, src);
+            return -1;
+        }
+    }
+
+    job->open = 3;
+    r->inflight++;
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+CLOSE ONE SOURCE OF A JOB
+-----------------------------------------------------------------
+*/
+static void job_close_source(struct runner *r, struct job *job, int src)
+{
+    epoll_ctl(r->epfd, EPOLL_CTL_DEL, job->fds[src], NULL);
+    close(job->fds[src]);
+    job->fds[src] = -1;
+    job->open--;
+}
+
+/*
+-----------------------------------------------------------------
+DRAIN A PIPE
+-----------------------------------------------------------------
+Reads until EAGAIN (more later) or EOF (source closed).
+*/
+static int job_drain(struct runner *r, struct job *job, int src)
+{
+    static char buf[READ_CHUNK];
+
+    for (;;)
+    {
+        ssize_t n = read(job->fds[src], buf, sizeof(buf));
+
+        if (n > 0)
+        {
+            if (r->discard)
+            {
+                continue;
+            }
+            struct capture *cap = r->interleaved ? &r->pending[src] : &job->out[src];
+            if (capture_add(cap, buf, n) == -1)
+            {
+                return -1;
+            }
+        }
+        else if (n == 0)
+        {
+            job_close_source(r, job, src);
+            return 0;
+        }
+        else if (errno == EAGAIN)
+        {
+            return 0;
+        }
+        else if (errno != EINTR)
+        {
+            return -1;
+        }
+    }
+}
+
+/*
+-----------------------------------------------------------------
+EMIT FINISHED JOBS IN INPUT ORDER
+-----------------------------------------------------------------
+*/
+static void emit_ordered(struct runner *r)
+{
+    while (r->next_emit < r->count && r->jobs[r->next_emit].open == 0 &&
+           r->jobs[r->next_emit].pid != 0)
+    {
+        struct job *job = &r->jobs[r->next_emit];
+
+        capture_flush(&job->out[SRC_STDOUT], STDOUT_FILENO);
+        capture_flush(&job->out[SRC_STDERR], STDERR_FILENO);
+        r->next_emit++;
+    }
+}
+
+/*
+-----------------------------------------------------------------
+RUN ALL JOBS
+-----------------------------------------------------------------
+*/
+static int run_jobs(struct runner *r)
+{
+    struct epoll_event events[MAX_EVENTS];
+
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r->epfd == -1)
+    {
+        return -1;
+    }
+
+    while (r->finished < r->count)
+    {
+        /* Keep K commands in flight */
+        while (r->inflight < r->max_inflight && r->next_start < r->count)
+        {
+            if (job_start(r, r->next_start++) == -1)
+            {
+                return -1;
+            }
+        }
+
+        int n = epoll_wait(r->epfd, events, MAX_EVENTS, -1);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            struct job *job = &r->jobs[events[i].data.u64 / 4];
+            int src = (int)(events[i].data.u64 % 4);
+
+            if (src == SRC_PIDFD)
+            {
+                /* pidfd keeps the PID reserved, so wait4() is race free */
+                wait4(job->pid, &job->status, 0, &job->usage);
+                job->wall_ms = now_ms() - job->start_ms;
+                job_close_source(r, job, src);
+            }
+            else if (job_drain(r, job, src) == -1)
+            {
+                return -1;
+            }
+
+            if (job->open == 0)
+            {
+                r->inflight--;
+                r->finished++;
+            }
+        }
+
+        /* One writev() per stream per loop turn */
+        if (r->interleaved)
+        {
+            capture_flush(&r->pending[SRC_STDOUT], STDOUT_FILENO);
+            capture_flush(&r->pending[SRC_STDERR], STDERR_FILENO);
+        }
+        else if (!r->discard)
+        {
+            emit_ordered(r);
+        }
+    }
+
+    close(r->epfd);
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+CPU TIME OF A JOB (USER + SYSTEM)
+-----------------------------------------------------------------
+*/
+static double job_cpu_ms(const struct job *job)
+{
+    const struct rusage *ru = &job->usage;
+
+    return (ru->ru_utime.tv_sec + ru->ru_stime.tv_sec) * 1e3 +
+           (ru->ru_utime.tv_usec + ru->ru_stime.tv_usec) / 1e3;
+}
+
+/*
+-----------------------------------------------------------------
+RESET JOBS FOR ANOTHER RUN
+-----------------------------------------------------------------
+*/
+static void runner_reset(struct runner *r)
+{
+    for (int i = 0; i < r->count; i++)
+    {
+        char *cmd = r->jobs[i].cmd;
+
+        memset(&r->jobs[i], 0, sizeof(struct job));
+        r->jobs[i].cmd = cmd;
+    }
+    r->next_start = 0;
+    r->next_emit = 0;
+    r->inflight = 0;
+    r->finished = 0;
+}
+
+/*
+-----------------------------------------------------------------
+BENCHMARK: THROUGHPUT AS K SCALES
+-----------------------------------------------------------------
+*/
+static int benchmark(struct runner *r, int cores)
+{
+    static char cmd[] = "i=0; while [ $i -lt 20000 ]; do i=$((i+1)); done; echo $i";
+    double base = 0;
+
+    r->count = 8 * cores > 32 ? 8 * cores : 32;
+    r->jobs = calloc(r->count, sizeof(struct job));
+    if (r->jobs == NULL)
+    {
+        return -1;
+    }
+    for (int i = 0; i < r->count; i++)
+    {
+        r->jobs[i].cmd = cmd;
+    }
+    r->discard = 1;
+
+    printf("Commands: %d, CPU cores: %d\n", r->count, cores);
+    printf("%6s %10s %12s %10s %14s\n", "K", "wall ms", "commands/s", "speedup", "avg cpu ms");
+
+    for (int k = 1; k <= 2 * cores; k *= 2)
+    {
+        runner_reset(r);
+        r->max_inflight = k;
+
+        double start = now_ms();
+        if (run_jobs(r) == -1)
+        {
+            return -1;
+        }
+        double wall = now_ms() - start;
+
+        double cpu = 0;
+        for (int i = 0; i < r->count; i++)
+        {
+            cpu += job_cpu_ms(&r->jobs[i]);
+        }
+        if (k == 1)
+        {
+            base = wall;
+        }
+
+        printf("%6d %10.1f %12.1f %9.2fx %14.2f\n", k, wall,
+               r->count / (wall / 1e3), base / wall, cpu / r->count);
+    }
+
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program runs commands from stdin in parallel and
+captures their output through one epoll loop.
+*/
+int main(int argc, char *argv[])
+{
+    struct runner r;
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int report = 1, bench = 0, opt;
+
+    memset(&r, 0, sizeof(r));
+    r.max_inflight = cores > 0 ? cores : 1;
+
+    while ((opt = getopt(argc, argv, "P:iqb")) != -1)
+    {
+        switch (opt)
+        {
+        case 'P': r.max_inflight = atoi(optarg); break;
+        case 'i': r.interleaved = 1; break;
+        case 'q': report = 0; break;
+        case 'b': bench = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-P K] [-i] [-q] [-b] < commands\n", argv[0]);
+            return 1;
+        }
+    }
+    if (r.max_inflight <= 0)
+    {
+        r.max_inflight = 1;
+    }
+
+    if (bench)
+    {
+        if (benchmark(&r, cores > 0 ? cores : 1) == -1)
+        {
+            perror("benchmark failed");
+            return 1;
+        }
+        return 0;
+    }
+
+    /*
+    STEP 1: Read commands, one per line
+    -----------------------------------
+    */
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t len;
+    int capacity = 0;
+
+    while ((len = getline(&line, &cap, stdin)) != -1)
+    {
+        if (len > 0 && line[len - 1] == '\n')
+        {
+            line[--len] = '\0';
+        }
+        if (len == 0)
+        {
+            continue;
+        }
+        if (r.count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 16;
+            r.jobs = realloc(r.jobs, capacity * sizeof(struct job));
+            if (r.jobs == NULL)
+            {
+                perror("realloc failed");
+                return 1;
+            }
+        }
+        memset(&r.jobs[r.count], 0, sizeof(struct job));
+        r.jobs[r.count].cmd = strdup(line);
+        if (r.jobs[r.count].cmd == NULL)
+        {
+            perror("strdup failed");
+            return 1;
+        }
+        r.count++;
+    }
+    free(line);
+
+    /*
+    STEP 2 - 5: Run with at most K in flight
+    ----------------------------------------
+    */
+    double start = now_ms();
+    if (run_jobs(&r) == -1)
+    {
+        perror("run failed");
+        return 1;
+    }
+    double wall = now_ms() - start;
+
+    /*
+    STEP 6: Per-command report on stderr
+    ------------------------------------
+    */
+    if (report)
+    {
+        fprintf(stderr, "\n%4s %6s %10s %10s  %s\n", "#", "exit", "wall ms", "cpu ms", "command");
+        for (int i = 0; i < r.count; i++)
+        {
+            struct job *job = &r.jobs[i];
+            int code = WIFEXITED(job->status) ? WEXITSTATUS(job->status) : 128 + WTERMSIG(job->status);
+
+            fprintf(stderr, "%4d %6d %10.2f %10.2f  %s\n", i, code, job->wall_ms,
+                    job_cpu_ms(job), job->cmd);
+        }
+        fprintf(stderr, "%d commands, K=%d, %.1f ms, %.1f commands/s\n", r.count,
+                r.max_inflight, wall, wall > 0 ? r.count / (wall / 1e3) : 0.0);
+    }
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. Keep at most K children running, start more as they finish
+2. Redirect child stdout/stderr with pipe2() + dup2()
+3. Non-blocking read ends: read until EAGAIN
+4. One epoll set watches all pipes and all pidfds
+5. writev() writes many captured chunks with one syscall
+6. wait4() returns the child's CPU time in rusage
+7. Ordered mode = output grouped by command in input order
+
+DEFINITION (IN SIMPLE WORDS):
+The runner starts several commands at once, catches
+everything they print, and shows it neatly while
+measuring how long each command took.
+
+REAL-TIME EXAMPLES:
+- xargs -P and GNU parallel
+- Build systems (make -j, ninja)
+- Test runners
+- Batch job schedulers
+
+=================================================================
+*/
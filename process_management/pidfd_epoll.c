@@ -0,0 +1,438 @@
+/*
+=================================================================
+PIDFD + EPOLL CHILD MANAGER – PROCESS MANAGEMENT (LINUX)
+=================================================================
+
+THIS PROGRAM DEMONSTRATES:
+1. What a pidfd (process file descriptor) is
+2. How child exit is watched with epoll like any other fd
+3. How sockets and children share ONE event loop
+4. How a child is reaped with waitid(P_PIDFD)
+5. How resource usage (rusage) is collected when reaping
+6. How thousands of children are managed without SIGCHLD
+
+DEFINITION:
+A pidfd is a file descriptor that refers to one specific
+process. It becomes readable when that process exits, so
+it can be placed in an epoll set next to sockets and pipes.
+Because the fd always refers to the same process, there is
+no PID-reuse race and no need for a SIGCHLD handler.
+
+SYNTAX (MAJOR CALLS USED):
+int pidfd_open(pid_t pid, unsigned int flags);
+int epoll_create1(int flags);
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+int epoll_wait(int epfd, struct epoll_event *events,
+               int maxevents, int timeout);
+int waitid(idtype_t idtype, id_t id, siginfo_t *info,
+           int options, struct rusage *ru);
+
+SYNTAX EXPLANATION:
+pidfd_open()      -> Returns an fd for process pid
+                     (called through syscall(SYS_pidfd_open))
+
+EPOLLIN on pidfd  -> Process has exited and can be reaped
+
+P_PIDFD           -> waitid() id is a pidfd, not a PID
+
+struct rusage *ru -> 5th argument of the raw waitid system
+                     call; filled with the same data wait4()
+                     returns (CPU time, max RSS, faults, ...)
+
+KEY POINTS:
+- pidfd_open() works even if the child already exited,
+  because it stays a zombie until WE reap it
+- waitid(P_PIDFD) reaps exactly that child, never another
+- Raw waitid() returns rusage, just like wait4()
+- No SIGCHLD handler, so no signal races
+- The same epoll_wait() also serves socket events
+- Open file limit is raised for thousands of pidfds
+
+WHY pidfd + epoll?
+- wait(NULL) blocks and cannot wait for I/O at the same time
+- SIGCHLD handlers are racy and hard to combine with I/O
+- PID numbers can be reused; pidfds cannot be confused
+- Scales to thousands of concurrent children
+
+IMPORTANT APIs:
+pidfd_open()  -> Get fd for a child
+epoll_ctl()   -> Register pidfd / socket
+epoll_wait()  -> Wait for exits and I/O together
+waitid()      -> Reap child + collect rusage
+setrlimit()   -> Allow many open fds
+
+WHAT THIS PROGRAM DOES (STEP BY STEP):
+
+STEP 1: Raises RLIMIT_NOFILE for many pidfds
+STEP 2: Creates epoll set and a socketpair
+STEP 3: Registers the socket in the epoll set
+STEP 4: Forks N children, registers each pidfd
+STEP 5: One child also sends a message over the socket
+STEP 6: epoll_wait() handles socket data and child exits
+STEP 7: Each exited child is reaped with waitid(P_PIDFD)
+STEP 8: Prints reaped count and aggregated rusage
+
+COMPILE:
+gcc pidfd_epoll.c
+./a.out [children]
+
+EXPECTED OUTPUT (WHEN PROGRAM IS RUN):
+
+1. Message received from a child over the socket
+2. Number of children spawned and reaped
+3. Total CPU time, max RSS, faults, context switches
+4. Elapsed time
+
+=================================================================
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>        // For printf(), perror()
+#include <stdlib.h>       // For malloc(), atoi()
+#include <string.h>       // For memset()
+#include <signal.h>       // For siginfo_t
+#include <time.h>         // For clock_gettime(), nanosleep()
+#include <unistd.h>       // For fork(), close(), syscall()
+#include <sys/epoll.h>    // For epoll_create1(), epoll_ctl(), epoll_wait()
+#include <sys/resource.h> // For struct rusage, setrlimit()
+#include <sys/socket.h>   // For socketpair(), send(), recv()
+#include <sys/syscall.h>  // For SYS_pidfd_open, SYS_waitid
+#include <sys/types.h>    // For pid_t
+#include <sys/wait.h>     // For waitid(), waitpid(), WEXITED
+
+#ifndef P_PIDFD
+#define P_PIDFD 3
+#endif
+
+#define DEFAULT_CHILDREN 2000
+#define MAX_EVENTS       256
+
+/* epoll tag for the socket; children use their index */
+#define SOCKET_TAG UINT64_MAX
+
+/*
+One managed child.
+*/
+struct child
+{
+    pid_t         pid;
+    int           pidfd;
+    int           status;
+    struct rusage usage;
+};
+
+/*
+Child manager: one epoll set for children and I/O.
+*/
+struct child_manager
+{
+    int           epfd;
+    struct child *children;
+    int           spawned;
+    int           running;
+};
+
+/*
+-----------------------------------------------------------------
+NOW IN MILLISECONDS
+-----------------------------------------------------------------
+*/
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+-----------------------------------------------------------------
+CHILD WORK
+-----------------------------------------------------------------
+Every child sleeps a little so that many of them are alive at
+the same time. Child 0 also talks over the socket.
+*/
+static void child_work(int index, int sock)
+{
+    struct timespec nap = { 0, (index % 50) * 100000L };
+
+    if (index == 0)
+    {
+        send(sock, "Hello from child 0", 18, 0);
+    }
+    nanosleep(&nap, NULL);
+    _exit(index % 7 == 0 ? 1 : 0);
+}
+
+/*
+-----------------------------------------------------------------
+SPAWN A CHILD AND WATCH ITS PIDFD
+-----------------------------------------------------------------
+*/
+static int manager_spawn(struct child_manager *mgr, int sock)
+{
+    int index = mgr->spawned;
+    struct child *c = &mgr->children[index];
+
+    c->pid = fork();
+    if (c->pid == -1)
+    {
+        return -1;
+    }
+    if (c->pid == 0)
+    {
+        child_work(index, sock);
+    }
+
+    /* On failure, reap the child so it is not left a zombie */
+    c->pidfd = (int)syscall(SYS_pidfd_open, c->pid, 0);
+    if (c->pidfd == -1)
+    {
+        waitpid(c->pid, NULL, 0);
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = (uint64_t)index;
+    if (epoll_ctl(mgr->epfd, EPOLL_CTL_ADD, c->pidfd, &ev) == -1)
+    {
+        close(c->pidfd);
+        waitpid(c->pid, NULL, 0);
+        return -1;
+    }
+
+    mgr->spawned++;
+    mgr->running++;
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+REAP ONE CHILD THROUGH ITS PIDFD
+-----------------------------------------------------------------
+glibc's waitid() has no rusage argument, so the raw system
+call is used to get wait4()-style accounting in one step.
+*/
+static int manager_reap(struct child_manager *mgr, int index)
+{
+    struct child *c = &mgr->children[index];
+    siginfo_t info;
+
+    memset(&info, 0, sizeof(info));
+    if (syscall(SYS_waitid, P_PIDFD, c->pidfd, &info, WEXITED, &c->usage) == -1)
+    {
+        return -1;
+    }
+
+    c->status = info.si_code == CLD_EXITED ? info.si_status : 128 + info.si_status;
+
+    epoll_ctl(mgr->epfd, EPOLL_CTL_DEL, c->pidfd, NULL);
+    close(c->pidfd);
+    c->pidfd = -1;
+    mgr->running--;
+    return 0;
+}
+
+/*
+-----------------------------------------------------------------
+RAISE OPEN FILE LIMIT
+-----------------------------------------------------------------
+Returns how many descriptors can be used.
+*/
+static rlim_t raise_fd_limit(void)
+{
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) == -1)
+    {
+        return 1024;
+    }
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    getrlimit(RLIMIT_NOFILE, &rl);
+
+    return rl.rlim_cur;
+}
+
+/*
+-----------------------------------------------------------------
+MAIN FUNCTION
+-----------------------------------------------------------------
+This program manages many children and a socket from one
+epoll loop, without wait(NULL) and without SIGCHLD.
+*/
+int main(int argc, char *argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : DEFAULT_CHILDREN;
+    struct child_manager mgr;
+    struct epoll_event events[MAX_EVENTS];
+    int sv[2];
+
+    /*
+    STEP 1: Allow many open pidfds
+    ------------------------------
+    */
+    rlim_t limit = raise_fd_limit();
+    if (count <= 0)
+    {
+        count = DEFAULT_CHILDREN;
+    }
+    if ((rlim_t)count > limit - 16)
+    {
+        count = (int)(limit - 16);
+    }
+
+    /*
+    STEP 2: Create epoll set and socketpair
+    ---------------------------------------
+    */
+    memset(&mgr, 0, sizeof(mgr));
+    mgr.epfd = epoll_create1(EPOLL_CLOEXEC);
+    mgr.children = calloc(count, sizeof(struct child));
+    if (mgr.epfd == -1 || mgr.children == NULL)
+    {
+        perror("epoll_create1 failed");
+        return 1;
+    }
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == -1)
+    {
+        perror("socketpair failed");
+        return 1;
+    }
+
+    /*
+    STEP 3: Watch the socket in the same epoll set
+    ----------------------------------------------
+    */
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = SOCKET_TAG;
+    if (epoll_ctl(mgr.epfd, EPOLL_CTL_ADD, sv[0], &ev) == -1)
+    {
+        perror("epoll_ctl failed");
+        return 1;
+    }
+
+    /*
+    STEP 4 + 5: Spawn children, one pidfd each
+    ------------------------------------------
+    */
+    double start = now_ms();
+    for (int i = 0; i < count; i++)
+    {
+        if (manager_spawn(&mgr, sv[1]) == -1)
+        {
+            perror("spawn failed");
+            break;
+        }
+    }
+    close(sv[1]);
+
+    /*
+    STEP 6 + 7: One loop for I/O and child exits
+    --------------------------------------------
+    */
+    int socket_open = 1;
+    while (mgr.running > 0 || socket_open)
+    {
+        int n = epoll_wait(mgr.epfd, events, MAX_EVENTS, -1);
+        if (n == -1)
+        {
+            perror("epoll_wait failed");
+            return 1;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.u64 == SOCKET_TAG)
+            {
+                char buf[64];
+                ssize_t r = recv(sv[0], buf, sizeof(buf) - 1, 0);
+
+                if (r <= 0)
+                {
+                    /* Every child closed its copy: EOF */
+                    epoll_ctl(mgr.epfd, EPOLL_CTL_DEL, sv[0], NULL);
+                    socket_open = 0;
+                    continue;
+                }
+                buf[r] = '\0';
+                printf("Socket message    : %s\n", buf);
+            }
+            else if (manager_reap(&mgr, (int)events[i].data.u64) == -1)
+            {
+                perror("waitid failed");
+                return 1;
+            }
+        }
+    }
+    double elapsed = now_ms() - start;
+
+    /*
+    STEP 8: Aggregate rusage
+    ------------------------
+    */
+    double user_ms = 0, sys_ms = 0;
+    long max_rss = 0, minflt = 0, majflt = 0, nvcsw = 0, nivcsw = 0;
+    int failed = 0;
+
+    for (int i = 0; i < mgr.spawned; i++)
+    {
+        struct rusage *ru = &mgr.children[i].usage;
+
+        user_ms += ru->ru_utime.tv_sec * 1e3 + ru->ru_utime.tv_usec / 1e3;
+        sys_ms += ru->ru_stime.tv_sec * 1e3 + ru->ru_stime.tv_usec / 1e3;
+        if (ru->ru_maxrss > max_rss)
+        {
+            max_rss = ru->ru_maxrss;
+        }
+        minflt += ru->ru_minflt;
+        majflt += ru->ru_majflt;
+        nvcsw += ru->ru_nvcsw;
+        nivcsw += ru->ru_nivcsw;
+        failed += mgr.children[i].status != 0;
+    }
+
+    printf("Children spawned  : %d\n", mgr.spawned);
+    printf("Children reaped   : %d (%d non-zero exit)\n", mgr.spawned - mgr.running, failed);
+    printf("CPU user / sys    : %.2f ms / %.2f ms\n", user_ms, sys_ms);
+    printf("Max RSS           : %ld KB\n", max_rss);
+    printf("Page faults       : %ld minor, %ld major\n", minflt, majflt);
+    printf("Context switches  : %ld voluntary, %ld involuntary\n", nvcsw, nivcsw);
+    printf("Elapsed           : %.1f ms\n", elapsed);
+
+    close(sv[0]);
+    close(mgr.epfd);
+    free(mgr.children);
+
+    return 0;
+}
+
+/*
+=================================================================
+SHORT NOTES – QUICK REVISION
+=================================================================
+
+1. pidfd_open() returns an fd that refers to one process
+2. pidfd becomes readable (EPOLLIN) when the process exits
+3. pidfds go into the same epoll set as sockets and pipes
+4. waitid(P_PIDFD, fd, ...) reaps exactly that child
+5. Raw waitid() also returns rusage like wait4()
+6. No SIGCHLD handler and no PID-reuse race
+7. Raise RLIMIT_NOFILE for thousands of children
+
+DEFINITION (IN SIMPLE WORDS):
+A pidfd turns "my child finished" into an ordinary
+readable file descriptor, so one loop can wait for
+children and network data at the same time.
+
+REAL-TIME EXAMPLES:
+- Service managers (systemd)
+- Job runners and build systems
+- Servers that spawn helper processes
+- Container runtimes
+
+=================================================================
+*/